@@ -0,0 +1,247 @@
+#include "heatmap.h"
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+#include "../wifi/wifi_config.h"
+#include "../sync/upload_guard.h"
+#include "../sync/upload_task.h"
+#include "../sys/heap_telemetry.h"
+#include "../log/log_ring.h"
+
+// ================= 全局变量定义 =================
+HeatmapStats heatmapStats = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+// 已发送、待确认的分片格子
+struct SentCell {
+    uint32_t index;
+    HeatmapCell cell;
+};
+
+static HeatmapCell* cells = NULL;
+static uint16_t cellMm = 0;
+static uint16_t cols = 0;
+static uint16_t rows = 0;
+static unsigned long periodStart = 0;
+static unsigned long lastFrameAt = 0;
+static bool cellsInPsram = false;
+static SentCell* sent = NULL;           // HEATMAP_CHUNK_CELLS 项
+static uint16_t sentCount = 0;
+
+// 快照上传状态(只由主循环读写)
+static uint32_t snapshotSeq = 0;        // 快照序号，heatmapReset 也会递增以作废在途分片
+static bool snapshotActive = false;
+static uint32_t snapPeriodMs = 0;       // 快照开始时冻结的周期时长与帧数
+static uint32_t snapFrames = 0;
+static size_t chunkCursor = 0;          // 下一片的起始格
+static size_t chunkNext = 0;            // 在途分片之后的格
+static uint16_t chunkIndex = 0;
+static bool chunkLast = false;
+static uint32_t chunkRuns = 0;          // 最近生成的分片的段数/格数
+static uint16_t chunkCells = 0;
+
+bool heatmapInit(uint16_t newCellMm) {
+    if (newCellMm < HEATMAP_MIN_CELL_MM || newCellMm > HEATMAP_MAX_CELL_MM) return false;
+    uint16_t newCols = (HEATMAP_MAX_X_MM - HEATMAP_MIN_X_MM + newCellMm - 1) / newCellMm;
+    uint16_t newRows = (HEATMAP_MAX_Y_MM - HEATMAP_MIN_Y_MM + newCellMm - 1) / newCellMm;
+    size_t n = (size_t)newCols * newRows;
+
+    if (cells != NULL) {
+        heap_caps_free(cells);
+        cells = NULL;
+    }
+    if (sent == NULL) {
+        sent = (SentCell*)heap_caps_malloc(HEATMAP_CHUNK_CELLS * sizeof(SentCell), MALLOC_CAP_SPIRAM);
+        if (sent == NULL) sent = (SentCell*)heap_caps_malloc(HEATMAP_CHUNK_CELLS * sizeof(SentCell), MALLOC_CAP_8BIT);
+    }
+    cellsInPsram = true;
+    cells = (HeatmapCell*)heap_caps_calloc(n, sizeof(HeatmapCell), MALLOC_CAP_SPIRAM);
+    if (cells == NULL) {
+        // 无 PSRAM 时退回内部 RAM
+        cellsInPsram = false;
+        cells = (HeatmapCell*)heap_caps_calloc(n, sizeof(HeatmapCell), MALLOC_CAP_8BIT);
+    }
+    if (cells == NULL) {
+        cellMm = cols = rows = 0;
+        LOG_E(LOG_MOD_SYS, "[HEATMAP] 分配 %lu 字节失败\n", (unsigned long)(n * sizeof(HeatmapCell)));
+        return false;
+    }
+    cellMm = newCellMm;
+    cols = newCols;
+    rows = newRows;
+    heatmapReset();
+    return true;
+}
+
+void heatmapReset() {
+    if (cells != NULL) memset(cells, 0, (size_t)cols * rows * sizeof(HeatmapCell));
+    heatmapStats.frames = 0;
+    heatmapStats.samples = 0;
+    heatmapStats.outOfRange = 0;
+    periodStart = millis();
+    lastFrameAt = 0;
+    snapshotActive = false;
+    snapshotSeq++;
+    sentCount = 0;
+}
+
+void heatmapAddFrame(const FusedTarget* targets, int count, unsigned long now) {
+    if (cells == NULL) return;
+    // 本帧代表从上一帧到现在的这段时间
+    uint32_t dt = (lastFrameAt == 0) ? 0 : now - lastFrameAt;
+    if (dt > HEATMAP_MAX_FRAME_DT_MS) dt = HEATMAP_MAX_FRAME_DT_MS;
+    lastFrameAt = now;
+    heatmapStats.frames++;
+
+    for (int i = 0; i < count; i++) {
+        int32_t cx = ((int32_t)targets[i].x - HEATMAP_MIN_X_MM) / cellMm;
+        int32_t cy = ((int32_t)targets[i].y - HEATMAP_MIN_Y_MM) / cellMm;
+        if (targets[i].x < HEATMAP_MIN_X_MM || targets[i].y < HEATMAP_MIN_Y_MM || cx >= cols || cy >= rows) {
+            heatmapStats.outOfRange++;
+            continue;
+        }
+        HeatmapCell& c = cells[cy * cols + cx];
+        c.dwellMs += dt;
+        c.count++;
+        heatmapStats.samples++;
+    }
+}
+
+// 从 cursor 起生成一个分片；sentOut 非空时记录发送的格子(下标与值)，上传成功后据此扣减
+static bool buildChunk(String& payload, size_t& cursor, uint32_t seq, uint16_t chunk,
+                       uint32_t periodMs, uint32_t frames, SentCell* sentOut, uint16_t* sentCount) {
+    ArduinoJson::JsonDocument doc;
+    doc["device_mac"] = deviceMac;
+    doc["seq"] = seq;
+    doc["chunk"] = chunk;
+    doc["period_ms"] = periodMs;
+    doc["frames"] = frames;
+    doc["cell_mm"] = cellMm;
+    doc["origin_x"] = HEATMAP_MIN_X_MM;
+    doc["origin_y"] = HEATMAP_MIN_Y_MM;
+    doc["cols"] = cols;
+    doc["rows"] = rows;
+    auto runs = doc["runs"].to<ArduinoJson::JsonArray>();
+
+    uint16_t cellCount = 0;
+    chunkRuns = 0;
+    size_t n = (size_t)cols * rows;
+    size_t i = cursor;
+    ArduinoJson::JsonArray d, cnt;
+    bool inRun = false;
+    for (; i < n && cells != NULL && cellCount < HEATMAP_CHUNK_CELLS; i++) {
+        if (cells[i].count == 0) {
+            inRun = false;
+            continue;
+        }
+        if (!inRun) {
+            auto run = runs.add<ArduinoJson::JsonObject>();
+            run["i"] = i;
+            d = run["d"].to<ArduinoJson::JsonArray>();
+            cnt = run["n"].to<ArduinoJson::JsonArray>();
+            inRun = true;
+            chunkRuns++;
+        }
+        d.add(cells[i].dwellMs);
+        cnt.add(cells[i].count);
+        if (sentOut != NULL) {
+            sentOut[cellCount].index = (uint32_t)i;
+            sentOut[cellCount].cell = cells[i];
+        }
+        cellCount++;
+    }
+    // 片满时跳过紧随其后的空格，避免最后一片恰好装满时再多发一个空片
+    while (i < n && cells != NULL && cells[i].count == 0) i++;
+    bool last = i >= n;
+    doc["last"] = last;
+
+    payload = "";
+    serializeJson(doc, payload);
+    if (sentCount != NULL) *sentCount = cellCount;
+    chunkCells = cellCount;
+    cursor = i;
+    return last;
+}
+
+bool heatmapBuildChunk(String& payload, size_t& cursor, uint16_t chunk) {
+    return buildChunk(payload, cursor, 0, chunk, millis() - periodStart, heatmapStats.frames, NULL, NULL);
+}
+
+// 冻结本周期的时长与帧数并开始新周期；网格不清零，分片上传成功后逐片扣减
+static void beginSnapshot() {
+    unsigned long now = millis();
+    snapshotSeq++;
+    snapshotActive = true;
+    snapPeriodMs = now - periodStart;
+    snapFrames = heatmapStats.frames;
+    chunkCursor = 0;
+    chunkIndex = 0;
+    heatmapStats.frames = 0;
+    heatmapStats.samples = 0;
+    heatmapStats.outOfRange = 0;
+    periodStart = now;
+    heatmapStats.lastRuns = 0;
+    heatmapStats.lastCells = 0;
+    heatmapStats.lastChunks = 0;
+    heatmapStats.lastSnapshotBytes = 0;
+}
+
+void heatmapUploadIfDue(bool force) {
+    if (cells == NULL || sent == NULL) return;
+    if (!snapshotActive && !force && millis() - periodStart < HEATMAP_UPLOAD_INTERVAL_MS) return;
+    if (WiFi.status() != WL_CONNECTED || uploadBusy()) return;
+    if (!breakerAllowRequest()) return;
+
+    HeapScope heapScope(HEAP_SUB_SYNC);
+    if (!snapshotActive) beginSnapshot();
+    String payload;
+    chunkNext = chunkCursor;
+    chunkLast = buildChunk(payload, chunkNext, snapshotSeq, chunkIndex, snapPeriodMs, snapFrames, sent, &sentCount);
+    heatmapStats.lastRuns += chunkRuns;
+    heatmapStats.lastCells += chunkCells;
+    heatmapStats.lastSnapshotBytes += payload.length();
+    uploadSubmit(UPLOAD_KIND_HEATMAP, payload, snapshotSeq);
+}
+
+void heatmapUploadDone(uint32_t tag, bool ok, int httpCode) {
+    // 上传期间网格被清零或改了格子大小，已发送记录不再对应当前网格
+    if (!snapshotActive || tag != snapshotSeq || cells == NULL) return;
+    if (!ok) {
+        // 已确认的分片已扣减，其余留在网格中并入下个快照
+        snapshotActive = false;
+        heatmapStats.uploadFailures++;
+        LOG_W(LOG_MOD_SYNC, "[HEATMAP] 快照 #%lu 第 %u 片上传失败 (HTTP %d)，剩余部分并入下个快照\n",
+              (unsigned long)tag, chunkIndex, httpCode);
+        return;
+    }
+    // 上传期间格子只会增加，扣减后保留期间新增的采样
+    for (uint16_t k = 0; k < sentCount; k++) {
+        HeatmapCell& c = cells[sent[k].index];
+        c.dwellMs -= sent[k].cell.dwellMs;
+        c.count -= sent[k].cell.count;
+    }
+    sentCount = 0;
+    chunkCursor = chunkNext;
+    chunkIndex++;
+    heatmapStats.lastChunks = chunkIndex;
+    if (!chunkLast) return;
+
+    snapshotActive = false;
+    heatmapStats.uploads++;
+    LOG_I(LOG_MOD_SYNC, "[HEATMAP] 快照 #%lu 已上传: %lu 格 / %lu 段 / %lu 片 / %lu 字节\n",
+          (unsigned long)tag, (unsigned long)heatmapStats.lastCells, (unsigned long)heatmapStats.lastRuns,
+          (unsigned long)heatmapStats.lastChunks, (unsigned long)heatmapStats.lastSnapshotBytes);
+}
+
+String getHeatmapStatusInfo() {
+    char line[320];
+    snprintf(line, sizeof(line),
+             "[HEATMAP] 网格=%ux%u 格子=%umm 内存=%lu字节(%s) 本周期=%lus 帧=%lu 采样=%lu 越界=%lu\n"
+             "          上传=%lu 失败=%lu%s 上次快照=%lu格/%lu段/%lu片/%lu字节",
+             cols, rows, cellMm, (unsigned long)((size_t)cols * rows * sizeof(HeatmapCell)),
+             cellsInPsram ? "PSRAM" : "内部RAM", (unsigned long)((millis() - periodStart) / 1000),
+             (unsigned long)heatmapStats.frames, (unsigned long)heatmapStats.samples,
+             (unsigned long)heatmapStats.outOfRange, (unsigned long)heatmapStats.uploads,
+             (unsigned long)heatmapStats.uploadFailures, snapshotActive ? "(快照上传中)" : "",
+             (unsigned long)heatmapStats.lastCells, (unsigned long)heatmapStats.lastRuns,
+             (unsigned long)heatmapStats.lastChunks, (unsigned long)heatmapStats.lastSnapshotBytes);
+    return String(line);
+}
@@ -0,0 +1,80 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <Arduino.h>
+#include "../radar/sensor_fusion.h"
+
+// ================= 占用热力图 =================
+// 设备端把(融合后的)目标位置累加到房间坐标网格中，网格放在 PSRAM：
+//   dwellMs  该格内目标停留的累计时间，每帧按帧间隔加权(间隔上限 HEATMAP_MAX_FRAME_DT_MS)
+//   count    该格内的目标采样次数
+// 每 HEATMAP_UPLOAD_INTERVAL_MS 上传一次稀疏快照，快照按行优先顺序切成分片，每片最多
+// HEATMAP_CHUNK_CELLS 个非零格，JSON 与请求体大小与格子边长无关(50mm 时网格为 160x160)。
+// 分片上传成功后从网格中减去已发送的值(上传期间新增的采样保留)；某片失败则中止本快照，
+// 未发送的部分留在网格中并入下个快照。
+//
+// 分片格式(POST SERVER_HEATMAP_URL)：
+//   {"device_mac": "...", "seq": 7, "chunk": 0, "last": false,
+//    "period_ms": 300000, "frames": 3000, "cell_mm": 200,
+//    "origin_x": -4000, "origin_y": 0, "cols": 40, "rows": 40,
+//    "runs": [{"i": 812, "d": [1200, 300], "n": [12, 3]}, ...]}
+// seq 为快照序号，chunk 为片序号，last 标记最后一片；period_ms/frames 为快照开始时冻结的周期值，
+// 各片相同。只发送非零格组成的连续段：i 为段起始下标，d/n 为段内各格的 dwellMs/count。
+// 各片(以及中止的快照已发送的片)的格值是增量，服务器按下标累加即得完整网格。
+
+#define HEATMAP_MIN_X_MM            -4000   // 网格覆盖的房间范围(mm)
+#define HEATMAP_MAX_X_MM            4000
+#define HEATMAP_MIN_Y_MM            0
+#define HEATMAP_MAX_Y_MM            8000
+#define HEATMAP_DEFAULT_CELL_MM     200     // 默认格子边长
+#define HEATMAP_MIN_CELL_MM         50
+#define HEATMAP_MAX_CELL_MM         1000
+#define HEATMAP_MAX_FRAME_DT_MS     500     // 单帧计入的最长时间，避免断流/阻塞期间虚增停留
+#define HEATMAP_UPLOAD_INTERVAL_MS  (5UL * 60 * 1000)   // 快照上传周期
+#define HEATMAP_CHUNK_CELLS         256     // 每个分片最多的非零格数(最坏约 8KB JSON)
+
+// 网格单元
+struct HeatmapCell {
+    uint32_t dwellMs;
+    uint32_t count;
+};
+
+// 热力图统计
+struct HeatmapStats {
+    uint32_t frames;            // 本周期累加的帧数
+    uint32_t samples;           // 本周期累加的目标采样数
+    uint32_t outOfRange;        // 落在网格外被丢弃的采样数
+    uint32_t uploads;           // 成功上传的快照数
+    uint32_t uploadFailures;    // 上传失败次数
+    uint32_t lastSnapshotBytes; // 最近一次快照各分片 JSON 大小之和
+    uint32_t lastRuns;          // 最近一次快照的段数
+    uint32_t lastCells;         // 最近一次快照的非零格数
+    uint32_t lastChunks;        // 最近一次快照的分片数
+};
+
+extern HeatmapStats heatmapStats;
+
+// 按格子边长分配(优先 PSRAM)并清零网格；失败返回 false
+bool heatmapInit(uint16_t cellMm);
+
+// 累加一帧目标(房间坐标)
+void heatmapAddFrame(const FusedTarget* targets, int count, unsigned long now);
+
+// 清零网格并开始新周期
+void heatmapReset();
+
+// 从 cursor 起生成一个快照分片(seq 为 0，只读，不影响上传)，cursor 前移到分片之后；
+// 返回是否为最后一片。heatmap dump 逐片输出
+bool heatmapBuildChunk(String& payload, size_t& cursor, uint16_t chunk);
+
+// 周期到期时开始一个快照，并在上传任务空闲时依次提交分片；force 时立即开始
+void heatmapUploadIfDue(bool force = false);
+
+// 上传任务交回分片上传结果(主循环调用)，tag 为提交时的快照序号：
+// 成功后减去已发送的值，失败中止本快照、未发送的部分留待下个快照
+void heatmapUploadDone(uint32_t tag, bool ok, int httpCode);
+
+// 获取热力图状态信息
+String getHeatmapStatusInfo();
+
+#endif // HEATMAP_H
@@ -0,0 +1,77 @@
+#include "track_compressor.h"
+#include <math.h>
+
+// 每轴容差：欧氏误差 ε 分到两轴，并预留关键点取整的 0.5mm
+static float axisTolerance(float maxErrorMm) {
+    return maxErrorMm * 0.70710678f - 0.5f;
+}
+
+void TrackCompressor::endPoint(TrajPoint& out) {
+    // 区间中值速度对锚点之后的全部采样点都满足误差约束
+    float dt = (float)(lastT - at);
+    out.ts = lastT;
+    out.x = (int16_t)lroundf(ax + (vxLo + vxHi) * 0.5f * dt);
+    out.y = (int16_t)lroundf(ay + (vyLo + vyHi) * 0.5f * dt);
+    out.end = 0;
+}
+
+bool TrackCompressor::add(uint32_t ts, int16_t x, int16_t y, float tolMm, TrajPoint& out) {
+    if (!active) {
+        active = true;
+        havePoints = false;
+        at = lastT = ts;
+        ax = x;
+        ay = y;
+        out.ts = ts;
+        out.x = x;
+        out.y = y;
+        out.end = 0;
+        return true;
+    }
+    if (ts == lastT) return false;
+
+    float tol = axisTolerance(tolMm);
+    float dt = (float)(ts - at);
+    float loX = (x - tol - ax) / dt, hiX = (x + tol - ax) / dt;
+    float loY = (y - tol - ay) / dt, hiY = (y + tol - ay) / dt;
+
+    if (!havePoints) {
+        vxLo = loX; vxHi = hiX; vyLo = loY; vyHi = hiY;
+        havePoints = true;
+        lastT = ts;
+        return false;
+    }
+
+    float nLoX = fmaxf(vxLo, loX), nHiX = fminf(vxHi, hiX);
+    float nLoY = fmaxf(vyLo, loY), nHiY = fminf(vyHi, hiY);
+    if (nLoX <= nHiX && nLoY <= nHiY) {
+        vxLo = nLoX; vxHi = nHiX; vyLo = nLoY; vyHi = nHiY;
+        lastT = ts;
+        return false;
+    }
+
+    // 当前点无法并入本段：在上一采样时刻结束本段，关键点作为新锚点
+    endPoint(out);
+    at = out.ts;
+    ax = out.x;
+    ay = out.y;
+    dt = (float)(ts - at);
+    vxLo = (x - tol - ax) / dt; vxHi = (x + tol - ax) / dt;
+    vyLo = (y - tol - ay) / dt; vyHi = (y + tol - ay) / dt;
+    lastT = ts;
+    return true;
+}
+
+bool TrackCompressor::finish(TrajPoint& out) {
+    if (!active) return false;
+    active = false;
+    if (havePoints) {
+        endPoint(out);
+    } else {
+        out.ts = at;
+        out.x = ax;
+        out.y = ay;
+    }
+    out.end = 1;
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef TRACK_COMPRESSOR_H
+#define TRACK_COMPRESSOR_H
+
+#include <stdint.h>
+
+// ================= 单条轨迹的流式压缩 =================
+// 流式丢弃可由相邻关键点线性插值还原的中间点，保证任一原始点与还原位置的误差不超过 tolMm。
+// 算法：从锚点出发维护满足全部已读点误差约束的速度区间(X/Y 各一个区间，常数内存)；
+// 新点使区间为空时，在上一采样时刻用区间中值速度结束本段并输出关键点，以其为新锚点。
+// 每轴容差取 ε/√2 - 0.5，因此关键点取整后欧氏误差仍不超过 ε。
+// 不依赖 Arduino，误差上界由 test/test_track_compressor 在主机上检查。
+
+// 关键点
+struct TrajPoint {
+    uint32_t ts;
+    int16_t x;
+    int16_t y;
+    uint8_t track;
+    uint8_t end;
+};
+
+class TrackCompressor {
+public:
+    TrackCompressor() : active(false) {}
+    void reset() { active = false; }
+    bool isActive() const { return active; }
+    uint32_t lastTs() const { return lastT; }
+    // 输入一个采样点，产生关键点时写入 out 并返回 true
+    bool add(uint32_t ts, int16_t x, int16_t y, float tolMm, TrajPoint& out);
+    // 结束轨迹，输出末尾关键点(end=1)
+    bool finish(TrajPoint& out);
+
+private:
+    bool active;
+    bool havePoints;          // 锚点之后是否已有采样点
+    uint32_t at;              // 锚点
+    int16_t ax, ay;
+    uint32_t lastT;           // 最近一个采样点时间
+    float vxLo, vxHi, vyLo, vyHi;   // 可行速度区间(mm/ms)
+    void endPoint(TrajPoint& out);
+};
+
+#endif // TRACK_COMPRESSOR_H
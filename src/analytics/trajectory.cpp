@@ -0,0 +1,192 @@
+#include "trajectory.h"
+#include <esp_heap_caps.h>
+
+// ================= 全局变量定义 =================
+TrajStats trajStats = {0, 0, 0, 0};
+uint16_t trajMaxErrorMm = TRAJ_DEFAULT_MAX_ERROR_MM;
+
+static TrackCompressor tracks[TRAJ_MAX_TRACKS];
+static TrajPoint pointQueue[TRAJ_POINT_QUEUE];
+static int queueHead = 0;     // 最旧的点
+static int queueCount = 0;
+static int inFlightCount = 0; // 已组装进上传 payload、等待上传结果的点(位于队首)
+
+// ================= 关键点队列 =================
+
+static void enqueuePoint(const TrajPoint& p) {
+    if (queueCount == TRAJ_POINT_QUEUE) {
+        // 上传长时间失败：丢弃最旧的点
+        queueHead = (queueHead + 1) % TRAJ_POINT_QUEUE;
+        queueCount--;
+        if (inFlightCount > 0) inFlightCount--;
+        trajStats.queueDropped++;
+    }
+    pointQueue[(queueHead + queueCount) % TRAJ_POINT_QUEUE] = p;
+    queueCount++;
+    trajStats.pointsOut++;
+}
+
+void trajectoryAddFrame(RadarSensor& s, uint32_t now) {
+    float tol = trajMaxErrorMm;
+    for (int i = 0; i < RADAR_MAX_TARGETS; i++) {
+        uint8_t id = s.id * RADAR_MAX_TARGETS + i;
+        TrackCompressor& tc = tracks[id];
+        const Target& t = s.targets[i];
+        TrajPoint p;
+        p.track = id;
+
+        // 目标消失、单目标模式下的空槽位或断流过久：结束轨迹
+        bool present = i < s.targetCount() && !isEmptyTarget(t);
+        if (tc.isActive() && (!present || now - tc.lastTs() > TRAJ_MAX_GAP_MS)) {
+            if (tc.finish(p)) enqueuePoint(p);
+        }
+        if (!present) continue;
+
+        int16_t x, y;
+        s.toRoom(t, x, y);
+        trajStats.samplesIn++;
+        if (tc.add(now, x, y, tol, p)) enqueuePoint(p);
+    }
+}
+
+void trajectoryExpireTracks(uint32_t now) {
+    TrajPoint p;
+    for (int id = 0; id < TRAJ_MAX_TRACKS; id++) {
+        TrackCompressor& tc = tracks[id];
+        if (!tc.isActive() || (int32_t)(now - tc.lastTs()) <= TRAJ_MAX_GAP_MS) continue;
+        p.track = id;
+        if (tc.finish(p)) enqueuePoint(p);
+    }
+}
+
+int trajectoryPendingPoints() {
+    return queueCount;
+}
+
+int trajectoryAppendPoints(ArduinoJson::JsonArray arr) {
+    for (int i = 0; i < queueCount; i++) {
+        const TrajPoint& p = pointQueue[(queueHead + i) % TRAJ_POINT_QUEUE];
+        auto pt = arr.add<ArduinoJson::JsonArray>();
+        pt.add(p.ts);
+        pt.add(p.track);
+        pt.add(p.x);
+        pt.add(p.y);
+        pt.add(p.end);
+    }
+    inFlightCount = queueCount;
+    return queueCount;
+}
+
+void trajectoryCommitPoints(int count) {
+    // 上传在上传任务中进行，期间队列满会从队首丢弃最旧的点，即已发送的点(enqueuePoint 中同步扣减)，
+    // 只出队仍留在队列中的已发送点，不会误删之后新产生的点
+    if (count > inFlightCount) count = inFlightCount;
+    queueHead = (queueHead + count) % TRAJ_POINT_QUEUE;
+    queueCount -= count;
+    inFlightCount = 0;
+    trajStats.uploaded += count;
+}
+
+// ================= 合成轨迹回放 =================
+// 模拟 10Hz 采样的行走轨迹(直行、转向、驻留，叠加 ±20mm 测量噪声)，
+// 压缩后用关键点线性插值还原每个原始点，统计压缩比与误差。
+
+static uint32_t replayRand = 1;
+static uint32_t nextRand() {
+    replayRand = replayRand * 1664525u + 1013904223u;
+    return replayRand >> 8;
+}
+
+struct ReplaySample {
+    uint32_t ts;
+    int16_t x;
+    int16_t y;
+};
+
+void runTrajectoryReplay(uint32_t samples) {
+    // 上限保证下面的字节数不会溢出 size_t(32 位)，否则缓冲区会比写入的点数小
+    if (samples == 0 || samples > TRAJ_REPLAY_MAX_SAMPLES) {
+        Serial.printf("Replay: samples must be 1..%lu\n", (unsigned long)TRAJ_REPLAY_MAX_SAMPLES);
+        return;
+    }
+    size_t origBytes = (size_t)samples * sizeof(ReplaySample);
+    size_t keyBytes = ((size_t)samples + 1) * sizeof(TrajPoint);
+    ReplaySample* orig = (ReplaySample*)heap_caps_malloc(origBytes, MALLOC_CAP_SPIRAM);
+    TrajPoint* keys = (TrajPoint*)heap_caps_malloc(keyBytes, MALLOC_CAP_SPIRAM);
+    if (orig == NULL) orig = (ReplaySample*)malloc(origBytes);
+    if (keys == NULL) keys = (TrajPoint*)malloc(keyBytes);
+    if (orig == NULL || keys == NULL) {
+        Serial.println("Replay: out of memory");
+        free(orig);
+        free(keys);
+        return;
+    }
+
+    Serial.printf("\n--- Trajectory Replay: %lu samples, max error %u mm ---\n", (unsigned long)samples, trajMaxErrorMm);
+    replayRand = 12345;
+    float px = 0, py = 2000, heading = 0, speed = 800;   // mm, rad, mm/s
+    uint32_t ts = 0;
+    int legLeft = 0;
+    TrackCompressor tc;
+    uint32_t keyCount = 0;
+    unsigned long start = micros();
+
+    for (uint32_t i = 0; i < samples; i++) {
+        if (legLeft-- <= 0) {
+            // 新的一段：转向，或驻留(速度为 0)
+            legLeft = 10 + nextRand() % 40;
+            heading = (nextRand() % 6283) / 1000.0f;
+            speed = (nextRand() % 5 == 0) ? 0 : 300 + nextRand() % 1100;
+        }
+        uint32_t dt = 95 + nextRand() % 11;
+        ts += dt;
+        px += speed * cosf(heading) * dt / 1000.0f;
+        py += speed * sinf(heading) * dt / 1000.0f;
+        // 碰到房间边界反弹
+        if (px < -3000 || px > 3000) { heading = PI - heading; px = constrain(px, -3000, 3000); }
+        if (py < 300 || py > 6000) { heading = -heading; py = constrain(py, 300, 6000); }
+
+        orig[i].ts = ts;
+        orig[i].x = (int16_t)lroundf(px) + (int16_t)(nextRand() % 41) - 20;
+        orig[i].y = (int16_t)lroundf(py) + (int16_t)(nextRand() % 41) - 20;
+        if (tc.add(orig[i].ts, orig[i].x, orig[i].y, trajMaxErrorMm, keys[keyCount])) keyCount++;
+    }
+    if (tc.finish(keys[keyCount])) keyCount++;
+    unsigned long elapsedUs = micros() - start;
+
+    // 还原：每个原始点在其所在关键点区间内线性插值
+    float maxErr = 0, sumErr = 0;
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < samples; i++) {
+        while (k + 1 < keyCount && keys[k + 1].ts < orig[i].ts) k++;
+        const TrajPoint& a = keys[k];
+        const TrajPoint& b = keys[(k + 1 < keyCount) ? k + 1 : k];
+        float f = (b.ts > a.ts) ? (float)(orig[i].ts - a.ts) / (b.ts - a.ts) : 0;
+        float rx = a.x + (b.x - a.x) * f;
+        float ry = a.y + (b.y - a.y) * f;
+        float err = sqrtf((rx - orig[i].x) * (rx - orig[i].x) + (ry - orig[i].y) * (ry - orig[i].y));
+        if (err > maxErr) maxErr = err;
+        sumErr += err;
+    }
+    free(orig);
+    free(keys);
+
+    Serial.printf("Replay done: %lu samples -> %lu key points (ratio %.1f:1), %.2f us/sample\n",
+                  (unsigned long)samples, (unsigned long)keyCount,
+                  keyCount ? (float)samples / keyCount : 0.0f, (float)elapsedUs / samples);
+    Serial.printf("  reconstruction error: max=%.1f mm  mean=%.1f mm  bound=%u mm\n",
+                  maxErr, samples ? sumErr / samples : 0.0f, trajMaxErrorMm);
+    Serial.println(maxErr <= trajMaxErrorMm ? ">> REPLAY PASS: error within bound" : ">> REPLAY FAIL: error bound exceeded");
+    Serial.println("--- Done ---\n");
+}
+
+String getTrajectoryStatusInfo() {
+    char line[200];
+    uint32_t ratioX10 = trajStats.pointsOut ? (uint32_t)((uint64_t)trajStats.samplesIn * 10 / trajStats.pointsOut) : 0;
+    snprintf(line, sizeof(line),
+             "[TRAJ] 最大误差=%umm 采样=%lu 关键点=%lu 压缩比=%lu.%lu:1 待上传=%d 已上传=%lu 丢弃=%lu",
+             trajMaxErrorMm, (unsigned long)trajStats.samplesIn, (unsigned long)trajStats.pointsOut,
+             (unsigned long)(ratioX10 / 10), (unsigned long)(ratioX10 % 10), queueCount,
+             (unsigned long)trajStats.uploaded, (unsigned long)trajStats.queueDropped);
+    return String(line);
+}
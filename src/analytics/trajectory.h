@@ -0,0 +1,58 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "../radar/radar_sensor.h"
+#include "track_compressor.h"
+
+// ================= 轨迹压缩 =================
+// 每个目标槽位(传感器 × 目标)一条轨迹，由 TrackCompressor(见 track_compressor.h)流式丢弃
+// 可由相邻关键点线性插值还原的中间点，保证任一原始点与还原位置的误差不超过 trajMaxErrorMm。
+// LD2450 的 speed 只是径向标量，无法外推二维位置，因此不参与预测。
+//
+// 关键点随数据上报的 track_points 字段上传：[[ts_ms, track, x, y, end], ...]
+// track = 传感器编号 × 3 + 目标序号，坐标为房间坐标，end=1 表示轨迹结束(目标消失/断流)。
+// 服务器在同一 track 相邻关键点之间线性插值即可还原轨迹。
+
+#define TRAJ_DEFAULT_MAX_ERROR_MM   100     // 默认最大位置误差
+#define TRAJ_MIN_ERROR_MM           10
+#define TRAJ_MAX_TRACKS             (RADAR_MAX_SENSORS * RADAR_MAX_TARGETS)
+#define TRAJ_MAX_GAP_MS             1000    // 超过此间隔无新点则结束轨迹
+#define TRAJ_POINT_QUEUE            128     // 待上传关键点队列(满时丢弃最旧的)
+#define TRAJ_REPLAY_MAX_SAMPLES     1000000UL   // traj replay 点数上限(与 pipeline bench 一致)
+
+// 轨迹统计
+struct TrajStats {
+    uint32_t samplesIn;         // 输入采样点
+    uint32_t pointsOut;         // 输出关键点
+    uint32_t queueDropped;      // 队列满丢弃的关键点
+    uint32_t uploaded;          // 已上传的关键点
+};
+
+extern TrajStats trajStats;
+extern uint16_t trajMaxErrorMm;
+
+// 每个完整数据帧调用：更新该传感器各目标槽位的轨迹
+void trajectoryAddFrame(RadarSensor& s, uint32_t now);
+
+// 结束超过 TRAJ_MAX_GAP_MS 没有新点的轨迹(传感器断流时 trajectoryAddFrame 不会被调用)，
+// 在组装上传数据前调用
+void trajectoryExpireTracks(uint32_t now);
+
+// 待上传关键点数
+int trajectoryPendingPoints();
+
+// 把待上传关键点追加到 JSON 数组(不出队，记为上传中)，返回追加数量
+int trajectoryAppendPoints(ArduinoJson::JsonArray arr);
+
+// 上传结果返回后调用：成功时传入追加数量出队，失败传 0 保留重试
+void trajectoryCommitPoints(int count);
+
+// 回放合成轨迹，报告压缩比与还原误差；samples 须在 1..TRAJ_REPLAY_MAX_SAMPLES
+void runTrajectoryReplay(uint32_t samples);
+
+// 获取轨迹压缩状态信息
+String getTrajectoryStatusInfo();
+
+#endif // TRAJECTORY_H
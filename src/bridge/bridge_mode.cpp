@@ -0,0 +1,128 @@
+#include "bridge_mode.h"
+
+// ================= 全局变量定义 =================
+BridgeStats bridgeStats = {0, 0, 0, 0, 0, 0, 0};
+
+#if !ARDUINO_USB_CDC_ON_BOOT
+// 串口接收错误回调：缓冲区满/FIFO溢出即为丢字节
+static void onPcRxError(hardwareSerial_error_t err) {
+    if (err == UART_BUFFER_FULL_ERROR || err == UART_FIFO_OVF_ERROR) bridgeStats.pcRxOverruns++;
+}
+#endif
+
+static void onRadarRxError(hardwareSerial_error_t err) {
+    if (err == UART_BUFFER_FULL_ERROR || err == UART_FIFO_OVF_ERROR) bridgeStats.radarRxOverruns++;
+}
+
+void runBridgeMode(HardwareSerial& radarPort, long radarBaud, const char* escape) {
+    char esc[BRIDGE_ESCAPE_MAX + 1];
+    strlcpy(esc, (escape != NULL && escape[0] != '\0') ? escape : BRIDGE_ESCAPE_DEFAULT, sizeof(esc));
+    int escLen = strlen(esc);
+
+    Serial.println("\n\n================================================");
+    Serial.println("       ENTERING TRANSPARENT BRIDGE MODE         ");
+    Serial.println("================================================");
+    Serial.println("1. ESP32 is now a USB-TTL bridge.");
+    Serial.println("2. CLOSE this Serial Monitor now.");
+    Serial.println("3. OPEN 'HLK-LD2450 Tool' and connect to this COM port.");
+    Serial.printf("4. To Exit: idle 1s, type '%s', idle 1s (or press RST).\n", esc);
+    Serial.println("================================================\n");
+    Serial.flush();
+
+    memset(&bridgeStats, 0, sizeof(bridgeStats));
+#if !ARDUINO_USB_CDC_ON_BOOT
+    Serial.onReceiveError(onPcRxError);
+#endif
+    radarPort.onReceiveError(onRadarRxError);
+
+    uint8_t buf[BRIDGE_BLOCK_SIZE];
+    uint8_t out[BRIDGE_BLOCK_SIZE + BRIDGE_ESCAPE_MAX];
+    int escMatched = 0;                      // 已匹配(暂扣未转发)的退出序列字节数
+    unsigned long lastPcRxAt = millis();
+    unsigned long start = millis();
+
+    while (true) {
+        // --- 雷达 -> USB：按 USB 发送缓冲区剩余空间块拷贝，不阻塞 ---
+        int n = min(radarPort.available(), Serial.availableForWrite());
+        if (n > 0) {
+            n = radarPort.read(buf, min(n, (int)sizeof(buf)));
+            Serial.write(buf, n);
+            bridgeStats.radarToPcBytes += n;
+            bridgeStats.radarToPcBlocks++;
+        }
+
+        // --- USB -> 雷达：块拷贝，同时检测退出序列 ---
+        n = min(Serial.available(), radarPort.availableForWrite() - BRIDGE_ESCAPE_MAX);
+        if (n > 0) {
+            unsigned long now = millis();
+            n = Serial.read(buf, min(n, (int)sizeof(buf)));
+            int outLen = 0;
+            for (int i = 0; i < n; i++) {
+                uint8_t b = buf[i];
+                bool silentBefore = (i == 0) && (now - lastPcRxAt >= BRIDGE_ESCAPE_GUARD_MS);
+                if (escMatched < escLen && b == (uint8_t)esc[escMatched] && (escMatched > 0 || silentBefore)) {
+                    escMatched++;
+                    continue;
+                }
+                // 匹配中断：暂扣的字节原样转发
+                if (escMatched > 0) {
+                    memcpy(out + outLen, esc, escMatched);
+                    outLen += escMatched;
+                    escMatched = 0;
+                }
+                out[outLen++] = b;
+            }
+            lastPcRxAt = now;
+            if (outLen > 0) {
+                radarPort.write(out, outLen);
+                bridgeStats.pcToRadarBytes += outLen;
+                bridgeStats.pcToRadarBlocks++;
+            }
+        }
+
+        if (escMatched > 0 && millis() - lastPcRxAt >= BRIDGE_ESCAPE_GUARD_MS) {
+            // 退出序列完整且其后保持静默
+            if (escMatched == escLen) break;
+            // 不完整的序列超时：原样转发
+            radarPort.write((const uint8_t*)esc, escMatched);
+            bridgeStats.pcToRadarBytes += escMatched;
+            escMatched = 0;
+        }
+
+        yield();
+    }
+
+    bridgeStats.durationMs = millis() - start;
+#if !ARDUINO_USB_CDC_ON_BOOT
+    // 控制台串口只有桥接注册接收错误回调(主循环注册的是 onReceive)，直接清除
+    Serial.onReceiveError(NULL);
+#endif
+    // 雷达串口的回调由调用方恢复(RadarSensor::attachErrorHandler)
+    radarPort.onReceiveError(NULL);
+
+    Serial.println("\n\n>>> 已退出透传桥接模式 <<<");
+    Serial.println(getBridgeStatusInfo(radarBaud));
+}
+
+String getBridgeStatusInfo(long radarBaud) {
+    char line[160];
+    String info = "[BRIDGE] 最近一次桥接: ";
+    info += bridgeStats.durationMs;
+    info += " ms";
+
+    // 8N1：每字节 10 bit
+    unsigned long secs = bridgeStats.durationMs / 1000;
+    if (secs == 0) secs = 1;
+    uint32_t lineRate = radarBaud / 10;
+    snprintf(line, sizeof(line), "\n[BRIDGE] USB->雷达: %lu B (%lu 块, 平均 %lu B/s, 线速 %lu B/s) 溢出=%lu",
+             (unsigned long)bridgeStats.pcToRadarBytes, (unsigned long)bridgeStats.pcToRadarBlocks,
+             (unsigned long)(bridgeStats.pcToRadarBytes / secs), (unsigned long)lineRate,
+             (unsigned long)bridgeStats.pcRxOverruns);
+    info += line;
+    snprintf(line, sizeof(line), "\n[BRIDGE] 雷达->USB: %lu B (%lu 块, 平均 %lu B/s, 线速 %lu B/s) 溢出=%lu",
+             (unsigned long)bridgeStats.radarToPcBytes, (unsigned long)bridgeStats.radarToPcBlocks,
+             (unsigned long)(bridgeStats.radarToPcBytes / secs), (unsigned long)lineRate,
+             (unsigned long)bridgeStats.radarRxOverruns);
+    info += line;
+    return info;
+}
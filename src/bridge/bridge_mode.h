@@ -0,0 +1,33 @@
+#ifndef BRIDGE_MODE_H
+#define BRIDGE_MODE_H
+
+#include <Arduino.h>
+
+// ================= 透传桥接配置 =================
+#define BRIDGE_BLOCK_SIZE       512     // 单次块读写的最大字节数
+#define BRIDGE_ESCAPE_DEFAULT   "+++"   // 默认退出序列
+#define BRIDGE_ESCAPE_MAX       8       // 退出序列最大长度
+#define BRIDGE_ESCAPE_GUARD_MS  1000    // 退出序列前后需保持静默的时间，避免上位机数据误触发
+
+// 桥接统计(每个方向)
+struct BridgeStats {
+    uint32_t pcToRadarBytes;     // USB -> 雷达
+    uint32_t radarToPcBytes;     // 雷达 -> USB
+    uint32_t pcToRadarBlocks;    // USB -> 雷达 块写次数
+    uint32_t radarToPcBlocks;    // 雷达 -> USB 块写次数
+    uint32_t pcRxOverruns;       // USB 串口接收溢出次数
+    uint32_t radarRxOverruns;    // 雷达串口接收溢出次数
+    unsigned long durationMs;    // 桥接持续时间
+};
+
+extern BridgeStats bridgeStats;
+
+// 进入透传桥接模式；收到退出序列(前后各静默 BRIDGE_ESCAPE_GUARD_MS)后返回控制台
+// radarPort 为要桥接的雷达串口；escape 为 NULL 或空串时使用默认序列
+// 期间替换 radarPort 的接收错误回调，返回后调用方须重新注册传感器自己的回调
+void runBridgeMode(HardwareSerial& radarPort, long radarBaud, const char* escape);
+
+// 获取最近一次桥接的统计信息
+String getBridgeStatusInfo(long radarBaud);
+
+#endif // BRIDGE_MODE_H
@@ -0,0 +1,404 @@
+#include "raw_capture.h"
+#include <esp_partition.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+#include "../radar/radar_sensor.h"
+#include "../log/log_ring.h"
+
+// ================= 全局变量定义 =================
+CaptureStats captureStats;
+bool captureActive = false;
+
+static const uint8_t BLOCK_MAGIC[4] = {'L', 'D', 'C', 'B'};
+#define FLASH_ENDURANCE     100000UL                   // NOR flash 扇区擦写寿命(次)
+
+// 写入队列消息(非负数为块下标)
+#define WRITER_MSG_BENCH    -1
+
+static_assert(CAPTURE_HEADER_SIZE >= 16 + RADAR_MAX_SENSORS * 4 + 4, "block header too small for sensor baud rates");
+
+// 环形存储分区
+static const esp_partition_t* part = NULL;
+static uint32_t ringSectors = 0;
+
+// 双缓冲(主循环填充，写入任务写出)
+static uint8_t* blocks[2] = {NULL, NULL};
+static volatile bool blockBusy[2] = {false, false};   // 已交给写入任务，写完由写入任务清除
+static int activeBlock = 0;
+static uint16_t activeLen = CAPTURE_HEADER_SIZE;
+static unsigned long activeSince = 0;                  // 当前块第一条记录的时间
+static uint32_t blockSeq = 0;
+static uint32_t sessionId = 0;
+static uint32_t flushMs = 0;
+static RadarSensor* const* capSensors = NULL;
+static int capSensorCount = 0;
+static bool stopping = false;                          // 已停止，最后一块还没交给写入任务
+
+// 写入任务
+static QueueHandle_t writeQueue = NULL;
+static TaskHandle_t writerTask = NULL;
+static uint32_t nextSector = 0;                        // 下一块写入的扇区(开始后只由写入任务读写)
+static uint32_t ringUsed = 0;                          // 本次抓包已写过的扇区数(达到 ringSectors 后开始覆盖)
+static volatile bool benchRunning = false;
+static uint32_t benchBlocks = 0;
+
+// 下载状态(只由主循环读写)
+static bool dumping = false;
+static uint32_t dumpSector = 0;                        // 当前扇区
+static uint32_t dumpSectorsLeft = 0;                   // 还要检查的扇区数(含当前)
+static uint32_t dumpOffset = 0;                        // 当前块内已输出的字节数
+static uint32_t dumpCrc = 0;
+
+static void putU16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+    putU16(p, v & 0xFFFF);
+    putU16(p + 2, v >> 16);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool openPartition() {
+    if (part != NULL) return true;
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, NULL);
+    if (part == NULL || part->size / CAPTURE_BLOCK_SIZE < 2) {
+        part = NULL;
+        LOG_E(LOG_MOD_SYS, "[CAPTURE] 找不到 spiffs 数据分区\n");
+        return false;
+    }
+    ringSectors = part->size / CAPTURE_BLOCK_SIZE;
+    return true;
+}
+
+// 读扇区块头；没有魔数(已擦除/写了一半/基准数据)返回 false
+static bool readHeader(uint32_t sector, uint32_t& seq, uint32_t& session) {
+    uint8_t h[CAPTURE_HEADER_SIZE];
+    if (esp_partition_read(part, sector * CAPTURE_BLOCK_SIZE, h, sizeof(h)) != ESP_OK) return false;
+    if (memcmp(h, BLOCK_MAGIC, 4) != 0) return false;
+    seq = getU32(h + 4);
+    session = getU32(h + 28);
+    return true;
+}
+
+// 最近一次抓包在环中的位置：块序号最小/最大的扇区与有效块数
+struct RingScan {
+    bool found;
+    uint32_t session;
+    uint32_t firstSector;
+    uint32_t lastSector;
+    uint32_t blocks;
+};
+
+static RingScan scanRing() {
+    RingScan r = {false, 0, 0, 0, 0};
+    uint32_t seq, session;
+    for (uint32_t i = 0; i < ringSectors; i++) {
+        if (readHeader(i, seq, session) && (!r.found || session > r.session)) {
+            r.found = true;
+            r.session = session;
+        }
+    }
+    if (!r.found) return r;
+    uint32_t minSeq = UINT32_MAX, maxSeq = 0;
+    for (uint32_t i = 0; i < ringSectors; i++) {
+        if (!readHeader(i, seq, session) || session != r.session) continue;
+        if (seq < minSeq) { minSeq = seq; r.firstSector = i; }
+        if (seq >= maxSeq) { maxSeq = seq; r.lastSector = i; }
+        r.blocks++;
+    }
+    return r;
+}
+
+// ================= 写入任务 =================
+
+// 擦除扇区 -> 写块体 -> 写块头；返回 擦除+写入 耗时(us)，失败返回 0
+static uint32_t writeSector(uint32_t sector, const uint8_t* block, uint32_t* eraseUs) {
+    uint32_t addr = sector * CAPTURE_BLOCK_SIZE;
+    uint32_t start = micros();
+    if (esp_partition_erase_range(part, addr, CAPTURE_BLOCK_SIZE) != ESP_OK) return 0;
+    if (eraseUs != NULL) *eraseUs = micros() - start;
+    if (esp_partition_write(part, addr + CAPTURE_HEADER_SIZE, block + CAPTURE_HEADER_SIZE,
+                            CAPTURE_BLOCK_SIZE - CAPTURE_HEADER_SIZE) != ESP_OK) return 0;
+    if (esp_partition_write(part, addr, block, CAPTURE_HEADER_SIZE) != ESP_OK) return 0;
+    uint32_t us = micros() - start;
+    return us ? us : 1;
+}
+
+static void writeBlock(const uint8_t* block) {
+    uint32_t us = writeSector(nextSector, block, NULL);
+    nextSector = (nextSector + 1) % ringSectors;
+    if (ringUsed < ringSectors) ringUsed++;
+    else captureStats.overwritten++;
+    if (us == 0) {
+        captureStats.writeErrors++;
+        return;
+    }
+    captureStats.blocksWritten++;
+    captureStats.writeTotalUs += us;
+    if (us > captureStats.writeMaxUs) captureStats.writeMaxUs = us;
+}
+
+// 写入基准：与抓包相同的 擦除 + 整块写入，从扇区 0 写起(块头不带魔数，不会被当成抓包块)
+static void benchBlocksNow(uint32_t count) {
+    uint8_t* buf = (uint8_t*)heap_caps_malloc(CAPTURE_BLOCK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (buf == NULL) {
+        LOG_E(LOG_MOD_SYS, "[CAPTURE] 基准缓冲分配失败\n");
+        return;
+    }
+    for (int i = 0; i < CAPTURE_BLOCK_SIZE; i++) buf[i] = (uint8_t)(i * 7);
+
+    uint64_t totalUs = 0, eraseTotalUs = 0;
+    uint32_t maxUs = 0, written = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        putU32(buf + 4, i);
+        uint32_t eraseUs = 0;
+        uint32_t us = writeSector(i % ringSectors, buf, &eraseUs);
+        if (us == 0) break;
+        written++;
+        totalUs += us;
+        eraseTotalUs += eraseUs;
+        if (us > maxUs) maxUs = us;
+    }
+    heap_caps_free(buf);
+
+    uint32_t kbpsX10 = totalUs ? (uint32_t)((uint64_t)written * CAPTURE_BLOCK_SIZE * 10000000ULL / totalUs / 1024) : 0;
+    uint32_t avgUs = written ? (uint32_t)(totalUs / written) : 0;
+    uint32_t eraseAvgUs = written ? (uint32_t)(eraseTotalUs / written) : 0;
+    LOG_I(LOG_MOD_SYS, "[CAPTURE] 写入基准: %lu/%lu 块 吞吐=%lu.%luKB/s 每块 平均=%luus(擦除 %luus) 最长=%luus\n",
+          (unsigned long)written, (unsigned long)count, (unsigned long)(kbpsX10 / 10), (unsigned long)(kbpsX10 % 10),
+          (unsigned long)avgUs, (unsigned long)eraseAvgUs, (unsigned long)maxUs);
+}
+
+static void captureWriterTask(void*) {
+    int msg;
+    for (;;) {
+        if (xQueueReceive(writeQueue, &msg, portMAX_DELAY) != pdTRUE) continue;
+        if (msg == WRITER_MSG_BENCH) {
+            benchBlocksNow(benchBlocks);
+            benchRunning = false;
+            continue;
+        }
+        writeBlock(blocks[msg]);
+        blockBusy[msg] = false;
+    }
+}
+
+static bool startWriter() {
+    if (writerTask != NULL) return true;
+    writeQueue = xQueueCreate(4, sizeof(int));
+    // 与网络任务同在核心0，优先级低于 WiFi/lwIP；雷达主循环在核心1
+    xTaskCreatePinnedToCore(captureWriterTask, "capture", 4096, NULL, 1, &writerTask, 0);
+    return writerTask != NULL;
+}
+
+// ================= 主循环侧 =================
+
+static void finishHeader(uint8_t* b) {
+    memcpy(b, BLOCK_MAGIC, 4);
+    putU32(b + 4, blockSeq++);
+    putU16(b + 8, activeLen);
+    b[10] = CAPTURE_VERSION;
+    b[11] = (uint8_t)capSensorCount;
+    putU32(b + 12, captureStats.droppedBytes);
+    for (int i = 0; i < RADAR_MAX_SENSORS; i++) {
+        putU32(b + 16 + i * 4, i < capSensorCount ? (uint32_t)capSensors[i]->currentBaudRate : 0);
+    }
+    putU32(b + 28, sessionId);
+    memset(b + activeLen, 0, CAPTURE_BLOCK_SIZE - activeLen);
+}
+
+// 把当前块交给写入任务并换到另一块；另一块还没写完时返回 false(当前块保持不变)
+static bool submitActive(bool partial) {
+    int next = activeBlock ^ 1;
+    if (blockBusy[next]) return false;
+    finishHeader(blocks[activeBlock]);
+    blockBusy[activeBlock] = true;
+    xQueueSend(writeQueue, &activeBlock, 0);   // 队列深度大于缓冲块数，不会满
+    if (partial) captureStats.partialBlocks++;
+    activeBlock = next;
+    activeLen = CAPTURE_HEADER_SIZE;
+    return true;
+}
+
+void captureRecord(uint8_t src, const uint8_t* data, uint16_t len) {
+    uint16_t need = CAPTURE_RECORD_HEADER + len;
+    if (need > CAPTURE_BLOCK_SIZE - CAPTURE_HEADER_SIZE ||
+        (activeLen + need > CAPTURE_BLOCK_SIZE && !submitActive(false))) {
+        captureStats.droppedBytes += len;
+        return;
+    }
+    if (activeLen == CAPTURE_HEADER_SIZE) activeSince = millis();
+    uint8_t* p = blocks[activeBlock] + activeLen;
+    putU32(p, micros());
+    p[4] = src;
+    putU16(p + 5, len);
+    memcpy(p + CAPTURE_RECORD_HEADER, data, len);
+    activeLen += need;
+    captureStats.bytesIn += len;
+    captureStats.records++;
+}
+
+// 逐段输出下载内容，每次不超过串口发送缓冲区的剩余空间
+static void serviceDump() {
+    uint8_t chunk[CAPTURE_DUMP_CHUNK];
+    int room = Serial.availableForWrite();
+    while (room > 0 && dumpSectorsLeft > 0) {
+        if (dumpOffset == 0) {
+            uint32_t seq, session;
+            if (!readHeader(dumpSector, seq, session) || session != sessionId) {
+                // 写入失败/断电留下的扇区：BEGIN 中的总数同样没有计入
+                dumpSector = (dumpSector + 1) % ringSectors;
+                dumpSectorsLeft--;
+                continue;
+            }
+        }
+        uint32_t n = min((uint32_t)room, min((uint32_t)sizeof(chunk), CAPTURE_BLOCK_SIZE - dumpOffset));
+        if (esp_partition_read(part, dumpSector * CAPTURE_BLOCK_SIZE + dumpOffset, chunk, n) != ESP_OK) break;
+        dumpCrc = esp_rom_crc32_le(dumpCrc, chunk, n);
+        Serial.write(chunk, n);
+        room -= n;
+        dumpOffset += n;
+        if (dumpOffset == CAPTURE_BLOCK_SIZE) {
+            dumpOffset = 0;
+            dumpSector = (dumpSector + 1) % ringSectors;
+            dumpSectorsLeft--;
+        }
+    }
+    if (dumpSectorsLeft == 0) {
+        Serial.printf("\nCAPTURE END %08lX\n", (unsigned long)dumpCrc);
+        dumping = false;
+        logHoldOutput(false);
+    }
+}
+
+void captureService(unsigned long now) {
+    if (dumping) serviceDump();
+    // 停止后提交最后一块；另一块还在写入时下一轮再试
+    if (stopping && submitActive(true)) stopping = false;
+    if (!captureActive || flushMs == 0 || activeLen == CAPTURE_HEADER_SIZE) return;
+    if (now - activeSince >= flushMs) submitActive(true);
+}
+
+bool captureBusy() {
+    return captureActive || stopping || blockBusy[0] || blockBusy[1] || benchRunning || dumping;
+}
+
+bool captureDumping() {
+    return dumping;
+}
+
+bool captureStart(RadarSensor* const* sensors, int count, uint16_t flushS) {
+    if (captureBusy() || !openPartition() || !startWriter()) return false;
+    for (int i = 0; i < 2; i++) {
+        // 块缓冲放内部 RAM：flash 写入期间 cache 关闭，驱动要从内部 RAM 取数据
+        if (blocks[i] == NULL) blocks[i] = (uint8_t*)heap_caps_malloc(CAPTURE_BLOCK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (blocks[i] == NULL) {
+            LOG_E(LOG_MOD_SYS, "[CAPTURE] 块缓冲分配失败\n");
+            return false;
+        }
+    }
+
+    // 接着上次抓包写，擦写在整个环上均匀分布
+    RingScan last = scanRing();
+    sessionId = last.found ? last.session + 1 : 1;
+    nextSector = last.found ? (last.lastSector + 1) % ringSectors : 0;
+    ringUsed = 0;
+
+    memset(&captureStats, 0, sizeof(captureStats));
+    blockSeq = 0;
+    blockBusy[0] = blockBusy[1] = false;
+    activeBlock = 0;
+    activeLen = CAPTURE_HEADER_SIZE;
+    capSensors = sensors;
+    capSensorCount = min(count, RADAR_MAX_SENSORS);
+    flushMs = (uint32_t)flushS * 1000;
+    captureStats.startedAt = millis();
+    captureActive = true;
+    return true;
+}
+
+void captureStop() {
+    if (!captureActive) return;
+    captureActive = false;
+    stopping = activeLen > CAPTURE_HEADER_SIZE;
+    if (stopping && submitActive(true)) stopping = false;
+    captureStats.stoppedAt = millis();
+}
+
+// ================= 下载 =================
+
+void captureDump() {
+    if (captureBusy()) {
+        Serial.println("Capture busy (running, writing or dumping), try again after: capture stop");
+        return;
+    }
+    if (!openPartition()) return;
+    RingScan r = scanRing();
+    uint32_t total = r.blocks * CAPTURE_BLOCK_SIZE;
+
+    // 二进制内容前清空积压日志，下载期间日志暂停、主循环不输出其他内容
+    logFlush();
+    logHoldOutput(true);
+    Serial.printf("CAPTURE BEGIN %lu %lu\n", (unsigned long)total, (unsigned long)r.blocks);
+    sessionId = r.session;
+    dumpSector = r.firstSector;
+    dumpSectorsLeft = r.found ? (r.lastSector + ringSectors - r.firstSector) % ringSectors + 1 : 0;
+    dumpOffset = 0;
+    dumpCrc = 0;
+    dumping = true;
+    serviceDump();
+}
+
+// ================= 写入基准 =================
+
+void runCaptureBench(uint32_t count) {
+    if (captureBusy()) {
+        Serial.println("Capture busy (running, writing or dumping), try again later");
+        return;
+    }
+    if (count == 0 || count > CAPTURE_BENCH_MAX_BLOCKS || !openPartition() || !startWriter()) {
+        Serial.printf("Capture bench: blocks must be 1..%d\n", CAPTURE_BENCH_MAX_BLOCKS);
+        return;
+    }
+    benchBlocks = count;
+    benchRunning = true;
+    int msg = WRITER_MSG_BENCH;
+    xQueueSend(writeQueue, &msg, 0);   // 写入任务空闲，队列必为空
+    Serial.printf("Capture bench: %lu blocks x %d B (erase + write) running on the writer task\n",
+                  (unsigned long)count, CAPTURE_BLOCK_SIZE);
+}
+
+String getCaptureStatusInfo() {
+    char line[420];
+    unsigned long end = captureActive ? millis() : captureStats.stoppedAt;
+    unsigned long elapsedMs = captureStats.startedAt ? end - captureStats.startedAt : 0;
+    float elapsedH = elapsedMs / 3600000.0f;
+
+    // 每写出一块恰好擦除一个扇区，按顺序绕环，每个扇区每写 ringSectors 块擦除一次
+    float blocksPerHour = elapsedH > 0 ? captureStats.blocksWritten / elapsedH : 0;
+    float cyclesPerHour = ringSectors ? blocksPerHour / ringSectors : 0;
+    float lifeYears = cyclesPerHour > 0 ? FLASH_ENDURANCE / cyclesPerHour / 8766.0f : 0;
+    float flashKBps = captureStats.writeTotalUs
+        ? captureStats.blocksWritten * (float)CAPTURE_BLOCK_SIZE * 1000000.0f / captureStats.writeTotalUs / 1024.0f : 0;
+    uint32_t blocks = captureStats.blocksWritten;
+
+    snprintf(line, sizeof(line),
+             "[CAPTURE] %s #%lu 时长=%lus 环=%lu扇区 覆盖=%lu块 原始=%lu字节(%lu B/s) 记录=%lu 丢弃=%lu字节 块=%lu(未满%lu) 错误=%lu\n"
+             "          写块(擦除+写入): 平均=%.1fms 最长=%.1fms flash吞吐=%.0fKB/s 写入=%.0fKB/h\n"
+             "          磨损: 擦除=%.0f扇区/h 每扇区=%.3f次/h 按%lu次寿命约%.1f年",
+             captureActive ? "运行中" : (stopping || blockBusy[0] || blockBusy[1] ? "停止中" : "已停止"),
+             (unsigned long)sessionId, elapsedMs / 1000, (unsigned long)ringSectors,
+             (unsigned long)captureStats.overwritten, (unsigned long)captureStats.bytesIn,
+             elapsedMs ? (unsigned long)((uint64_t)captureStats.bytesIn * 1000 / elapsedMs) : 0,
+             (unsigned long)captureStats.records, (unsigned long)captureStats.droppedBytes, (unsigned long)blocks,
+             (unsigned long)captureStats.partialBlocks, (unsigned long)captureStats.writeErrors,
+             blocks ? captureStats.writeTotalUs / 1000.0f / blocks : 0, captureStats.writeMaxUs / 1000.0f, flashKBps,
+             blocksPerHour * CAPTURE_BLOCK_SIZE / 1024.0f, blocksPerHour, cyclesPerHour,
+             FLASH_ENDURANCE, lifeYears);
+    return String(line);
+}
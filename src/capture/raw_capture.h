@@ -0,0 +1,98 @@
+#ifndef RAW_CAPTURE_H
+#define RAW_CAPTURE_H
+
+#include <Arduino.h>
+
+class RadarSensor;
+
+// ================= 原始字节流抓包 =================
+// 把雷达串口收到的原始字节(数据帧块读取 + 指令 ACK 帧)带时间戳写入 flash，用于现场问题复现。
+//
+// 写入路径：
+//   主循环 RadarSensor::poll() 读到的每一块字节追加为一条记录到当前 RAM 块(只做 memcpy)；
+//   块写满(或超过刷新间隔)后交给核心0上的写入任务，主循环换到另一块继续追加(双缓冲)。
+//   两块都在等待写入时新记录直接丢弃并计数，摄入路径从不等待 flash。
+//
+// 环形存储：不经文件系统，直接把默认分区表中的 spiffs 数据分区当作扇区环：
+//   每块 CAPTURE_BLOCK_SIZE = 一个 4KB flash 扇区，写入任务按顺序 擦除扇区 -> 写块体 -> 写块头，
+//   写到分区末尾后回到开头覆盖最旧的块。每块恰好擦除一次扇区，没有元数据提交与写时复制，
+//   每个扇区每绕环一圈擦写一次。块头最后写入，断电时写了一半的块没有魔数，下载时跳过。
+//   重启后扫描各扇区块头即可找回最近一次抓包；新抓包从上次结束的下一个扇区开始，擦写均匀分布。
+//
+// 块格式(小端，每块自描述，环形覆盖后剩余的块仍可独立解析)：
+//   [0..3]   魔数 "LDCB"
+//   [4..7]   块序号(本次抓包从 0 开始，每块 +1)
+//   [8..9]   块内有效字节数(含块头)
+//   [10]     版本 CAPTURE_VERSION
+//   [11]     传感器数
+//   [12..15] 截至本块累计丢弃的字节数
+//   [16..27] 各传感器当前波特率 3 × uint32
+//   [28..31] 抓包编号(每次 capture start +1，区分分区中残留的旧抓包块)
+//   记录：{t_us uint32 (micros()), src uint8, len uint16, data[len]}
+//         src 低 4 位为传感器编号，CAPTURE_SRC_ACK 表示该记录是一条完整的指令 ACK 帧
+// 主机端下载/解析/回放见 tools/capture_tool.py
+//
+// 停止、下载与写入基准都不阻塞主循环：停止只是把最后一块交给写入任务；下载由 captureService
+// 按串口发送缓冲区空间逐段输出；基准在写入任务中执行，结束后打印结果。
+
+#define CAPTURE_BLOCK_SIZE      4096
+#define CAPTURE_HEADER_SIZE     32
+#define CAPTURE_RECORD_HEADER   7
+#define CAPTURE_DEFAULT_FLUSH_S 10      // 未写满的块最长在 RAM 中停留的时间(单传感器约 10s 写满一块)
+#define CAPTURE_VERSION         2
+#define CAPTURE_SRC_ACK         0x10
+#define CAPTURE_BENCH_MAX_BLOCKS 256    // capture bench 上限(1MB)
+#define CAPTURE_DUMP_CHUNK      512     // 下载时每次从 flash 读出的字节数
+
+// 抓包统计
+struct CaptureStats {
+    uint32_t bytesIn;           // 写入块的原始字节数
+    uint32_t records;
+    uint32_t droppedBytes;      // 双缓冲都在等待写入时丢弃的字节数
+    uint32_t blocksWritten;
+    uint32_t partialBlocks;     // 因刷新间隔/停止而未写满就写出的块
+    uint32_t writeErrors;
+    uint32_t writeMaxUs;        // 单块 擦除+写入 最长耗时，期间两个核心的 flash cache 都被挂起
+    uint64_t writeTotalUs;
+    uint32_t overwritten;       // 环形覆盖的旧块数
+    unsigned long startedAt;
+    unsigned long stoppedAt;
+};
+
+extern CaptureStats captureStats;
+extern bool captureActive;      // 只由主循环读写
+
+// 开始抓包：新抓包编号，从上次抓包结束的下一个扇区开始写；flushS 为 0 时只写满块
+bool captureStart(RadarSensor* const* sensors, int count, uint16_t flushS);
+
+// 停止抓包：未满的块由 captureService 交给写入任务，不等待
+void captureStop();
+
+// 写入任务、停止收尾、下载或基准是否仍在进行
+bool captureBusy();
+
+// 是否正在下载(期间控制台串口只输出抓包内容)
+bool captureDumping();
+
+// 追加一条记录(由 RadarSensor 在读到字节时调用)
+void captureRecord(uint8_t src, const uint8_t* data, uint16_t len);
+inline void captureTap(uint8_t src, const uint8_t* data, uint16_t len) {
+    if (captureActive) captureRecord(src, data, len);
+}
+
+// 主循环每轮调用：到刷新间隔时把未写满的块交给写入任务，推进停止收尾与下载
+void captureService(unsigned long now);
+
+// 开始串口下载最近一次抓包：输出 "CAPTURE BEGIN <字节数> <块数>\n"，随后是按块序号拼接的全部块，
+// 最后 "\nCAPTURE END <crc32>\n"。内容由 captureService 逐段输出，期间日志暂停。
+// 抓包或写入任务忙时拒绝
+void captureDump();
+
+// flash 持续写入基准：在写入任务中按抓包相同的方式(擦除 + 整块写入)写 blocks(1..CAPTURE_BENCH_MAX_BLOCKS)块，
+// 从环的开头写起，会覆盖已保存的抓包；主循环不等待，结束后打印结果
+void runCaptureBench(uint32_t blocks);
+
+// 获取抓包状态、写入吞吐与 flash 磨损估算
+String getCaptureStatusInfo();
+
+#endif // RAW_CAPTURE_H
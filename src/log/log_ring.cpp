@@ -0,0 +1,287 @@
+#include "log_ring.h"
+#include "mpsc_ring.h"
+
+// 日志记录(存放在无锁环形缓冲区的槽中)
+struct LogSlot {
+    uint32_t ts;
+    const char* fmt;
+    uint32_t args[LOG_MAX_ARGS];
+    uint8_t level;
+    uint8_t module;
+    uint8_t argc;
+    uint8_t isHex;
+};
+
+// ================= 全局变量定义 =================
+uint8_t logModuleLevel[LOG_MOD_COUNT] = {
+    LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG
+};
+
+static MpscRing<LogSlot, LOG_RING_SIZE> ring;    // 只有主循环消费
+static std::atomic<uint32_t> droppedCount(0);
+static std::atomic<uint32_t> writtenCount(0);
+static uint32_t highWater = 0;
+static volatile bool outputHeld = false;         // 只由主循环设置
+static bool atLineStart = true;                  // 上一条输出以换行结束，下一条前加时间戳
+
+static const char* const MODULE_NAMES[LOG_MOD_COUNT] = {"radar", "cmd", "sync", "sys"};
+static const char* const LEVEL_NAMES[] = {"off", "error", "warn", "info", "debug"};
+
+void logInit() {
+    ring.reset();
+}
+
+// 申请一个空槽，缓冲区满返回 NULL
+static LogSlot* reserveSlot(uint32_t& pos) {
+    LogSlot* slot = ring.reserve(pos);
+    if (slot == NULL) droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+static void commitSlot(uint32_t pos) {
+    ring.commit(pos);
+    writtenCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void logPush(uint8_t level, uint8_t module, const char* fmt, const uint32_t* args, uint8_t argc) {
+    uint32_t pos;
+    LogSlot* slot = reserveSlot(pos);
+    if (slot == NULL) return;
+    slot->ts = millis();
+    slot->fmt = fmt;
+    memcpy(slot->args, args, sizeof(slot->args));
+    slot->level = level;
+    slot->module = module;
+    slot->argc = argc;
+    slot->isHex = 0;
+    commitSlot(pos);
+}
+
+void logHex(uint8_t level, uint8_t module, const char* prefix, const uint8_t* data, uint8_t len) {
+    if (level > logModuleLevel[module]) return;
+    if (len > sizeof(((LogSlot*)0)->args)) len = sizeof(((LogSlot*)0)->args);
+    uint32_t pos;
+    LogSlot* slot = reserveSlot(pos);
+    if (slot == NULL) return;
+    slot->ts = millis();
+    slot->fmt = prefix;
+    memcpy(slot->args, data, len);
+    slot->level = level;
+    slot->module = module;
+    slot->argc = len;
+    slot->isHex = 1;
+    commitSlot(pos);
+}
+
+// 格式化一条记录，返回长度；lineStart 时在行首加上记录产生的时间(秒.毫秒)，
+// 输出被推迟时仍能看出消息的实际时间
+static int formatSlot(const LogSlot* slot, char* out, size_t size, bool lineStart) {
+    int n = 0;
+    if (lineStart) {
+        n = snprintf(out, size, "[%lu.%03lu] ", (unsigned long)(slot->ts / 1000), (unsigned long)(slot->ts % 1000));
+        out += n;
+        size -= n;
+    }
+    if (slot->isHex) {
+        int h = snprintf(out, size, "%s", slot->fmt);
+        const uint8_t* bytes = (const uint8_t*)slot->args;
+        for (int i = 0; i < slot->argc && h < (int)size - 4; i++) {
+            h += snprintf(out + h, size - h, "%02X ", bytes[i]);
+        }
+        if (h < (int)size - 1) out[h++] = '\n';
+        return n + h;
+    }
+    const uint32_t* a = slot->args;
+    int m = snprintf(out, size, slot->fmt, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+    return n + ((m < (int)size) ? m : (int)size - 1);
+}
+
+// 取出队首记录并输出；blocking=false 时串口发送缓冲区不足则保留记录
+static bool drainOne(bool blocking) {
+    if (outputHeld) return false;
+    LogSlot* slot = ring.front();
+    if (slot == NULL) return false;
+
+    uint32_t used = ring.used();
+    if (used > highWater) highWater = used;
+
+    char line[LOG_LINE_MAX];
+    int len = formatSlot(slot, line, sizeof(line), atLineStart);
+    if (!blocking && Serial.availableForWrite() < len) return false;
+    Serial.write((const uint8_t*)line, len);
+    atLineStart = len > 0 && line[len - 1] == '\n';
+
+    ring.pop();
+    return true;
+}
+
+int logDrain(int maxRecords) {
+    int count = 0;
+    while (count < maxRecords && drainOne(false)) count++;
+    return count;
+}
+
+void logFlush() {
+    while (drainOne(true)) {}
+}
+
+bool logPending() {
+    if (outputHeld) return false;   // 暂停期间不让主循环为积压日志缩短等待
+    return ring.front() != NULL;
+}
+
+void logHoldOutput(bool hold) {
+    outputHeld = hold;
+}
+
+bool logOutputHeld() {
+    return outputHeld;
+}
+
+void logSetLevel(uint8_t module, uint8_t level) {
+    if (module >= LOG_MOD_COUNT) {
+        for (int i = 0; i < LOG_MOD_COUNT; i++) logModuleLevel[i] = level;
+    } else {
+        logModuleLevel[module] = level;
+    }
+}
+
+int logModuleFromName(const String& name) {
+    if (name.equalsIgnoreCase("all")) return LOG_MOD_COUNT;
+    for (int i = 0; i < LOG_MOD_COUNT; i++) {
+        if (name.equalsIgnoreCase(MODULE_NAMES[i])) return i;
+    }
+    return -1;
+}
+
+int logLevelFromName(const String& name) {
+    for (int i = 0; i <= LOG_LEVEL_DEBUG; i++) {
+        if (name.equalsIgnoreCase(LEVEL_NAMES[i])) return i;
+    }
+    return -1;
+}
+
+LogStats getLogStats() {
+    LogStats st;
+    st.written = writtenCount.load(std::memory_order_relaxed);
+    st.dropped = droppedCount.load(std::memory_order_relaxed);
+    st.highWater = highWater;
+    return st;
+}
+
+String getLogStatusInfo() {
+    LogStats st = getLogStats();
+    String info = "[LOG] 写入=";
+    info += st.written;
+    info += " 丢弃=";
+    info += st.dropped;
+    info += " 最高占用=";
+    info += st.highWater;
+    info += "/";
+    info += LOG_RING_SIZE;
+    info += "  级别:";
+    for (int i = 0; i < LOG_MOD_COUNT; i++) {
+        info += " ";
+        info += MODULE_NAMES[i];
+        info += "=";
+        info += LEVEL_NAMES[logModuleLevel[i]];
+    }
+    return info;
+}
+
+// ================= 写入开销基准 =================
+// 用周期计数测量热路径(写入环形缓冲区)与推迟到主循环的格式化各自的开销。
+// 每批写入半个缓冲区后直接丢弃(不输出)，结束时恢复统计计数。
+
+struct BenchResult {
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t n;
+};
+
+// 丢弃全部已提交的记录(不格式化)
+static void discardPending() {
+    while (ring.front() != NULL) ring.pop();
+}
+
+// 测量空调用的周期数，从结果中扣除
+static uint32_t measureOverhead() {
+    uint32_t best = UINT32_MAX;
+    for (int i = 0; i < 64; i++) {
+        uint32_t start = ESP.getCycleCount();
+        uint32_t c = ESP.getCycleCount() - start;
+        if (c < best) best = c;
+    }
+    return best;
+}
+
+template <typename F>
+static BenchResult benchCase(uint32_t count, uint32_t overhead, F fn) {
+    BenchResult r = {UINT32_MAX, 0, 0, 0};
+    for (uint32_t i = 0; i < count; i++) {
+        if (i % (LOG_RING_SIZE / 2) == 0) discardPending();
+        uint32_t start = ESP.getCycleCount();
+        fn();
+        uint32_t c = ESP.getCycleCount() - start;
+        c = (c > overhead) ? c - overhead : 0;
+        if (c < r.minCycles) r.minCycles = c;
+        if (c > r.maxCycles) r.maxCycles = c;
+        r.totalCycles += c;
+        r.n++;
+    }
+    discardPending();
+    return r;
+}
+
+static void printBench(const char* name, const BenchResult& r) {
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    uint32_t avg = r.n ? (uint32_t)(r.totalCycles / r.n) : 0;
+    Serial.printf("  %-22s min=%5lu avg=%5lu max=%6lu cycles  (avg %lu ns)\n", name, (unsigned long)r.minCycles,
+                  (unsigned long)avg, (unsigned long)r.maxCycles, (unsigned long)(avg * 1000UL / mhz));
+}
+
+void runLogBench(uint32_t count) {
+    logFlush();
+    Serial.printf("\n--- Log Bench: %lu records per case @ %lu MHz ---\n", (unsigned long)count,
+                  (unsigned long)ESP.getCpuFreqMHz());
+
+    uint8_t savedLevel = logModuleLevel[LOG_MOD_SYS];
+    uint32_t savedWritten = writtenCount.load(std::memory_order_relaxed);
+    uint32_t savedDropped = droppedCount.load(std::memory_order_relaxed);
+    uint32_t savedHighWater = highWater;
+    logModuleLevel[LOG_MOD_SYS] = LOG_LEVEL_INFO;
+    uint32_t overhead = measureOverhead();
+    static const uint8_t frame[30] = {0xAA, 0xFF, 0x03, 0x00, 0x10, 0x01, 0x52, 0x83, 0x00, 0x00, 0x68, 0x01};
+    volatile int32_t x = -272, y = 850;   // 防止参数被常量折叠
+
+    Serial.println("  写入(热路径)：");
+    printBench("LOG_I 0 args", benchCase(count, overhead, [] { LOG_I(LOG_MOD_SYS, "bench\n"); }));
+    printBench("LOG_I 3 args", benchCase(count, overhead, [&] { LOG_I(LOG_MOD_SYS, "[T%d %d,%d]\n", 1, x, y); }));
+    printBench("LOG_I 7 args", benchCase(count, overhead, [&] {
+        LOG_I(LOG_MOD_SYS, "%s[T1 %d,%d] [T2 %d,%d] [T3 %d,%d] \n", "Target: ", x, y, y, x, x, y);
+    }));
+    printBench("LOG_D filtered", benchCase(count, overhead, [&] { LOG_D(LOG_MOD_SYS, "[T%d %d,%d]\n", 1, x, y); }));
+    printBench("logHex 30 bytes", benchCase(count, overhead, [] { logHex(LOG_LEVEL_INFO, LOG_MOD_SYS, "RAW: ", frame, 30); }));
+
+    // 推迟到主循环的格式化开销(不含串口写)，以及不用缓冲区时热路径要付出的同等 snprintf
+    Serial.println("  格式化(主循环 logDrain 中)：");
+    LogSlot probe;
+    probe.ts = millis();
+    probe.fmt = "%s[T1 %d,%d] [T2 %d,%d] [T3 %d,%d] \n";
+    const uint32_t probeArgs[LOG_MAX_ARGS] = {(uint32_t)(uintptr_t)"Target: ", (uint32_t)-272, 850, 1200, (uint32_t)-35, 64, 4100, 0};
+    memcpy(probe.args, probeArgs, sizeof(probe.args));
+    probe.argc = 7;
+    probe.isHex = 0;
+    char line[LOG_LINE_MAX];
+    printBench("format 7 args", benchCase(count, overhead, [&] { formatSlot(&probe, line, sizeof(line), true); }));
+    printBench("snprintf 7 args", benchCase(count, overhead, [&] {
+        snprintf(line, sizeof(line), "%s[T1 %d,%d] [T2 %d,%d] [T3 %d,%d] \n", "Target: ", (int)x, (int)y, (int)y, (int)x, (int)x, (int)y);
+    }));
+
+    logModuleLevel[LOG_MOD_SYS] = savedLevel;
+    writtenCount.store(savedWritten, std::memory_order_relaxed);
+    droppedCount.store(savedDropped, std::memory_order_relaxed);
+    highWater = savedHighWater;
+    Serial.println("--- Done ---\n");
+}
@@ -0,0 +1,107 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// ================= 异步日志 =================
+// 热路径只写入紧凑的二进制记录(格式串地址 + 32位参数)到无锁环形缓冲区(mpsc_ring.h)，
+// 格式化与串口输出推迟到主循环末尾的 logDrain()，USB 主机不读取时也不会阻塞雷达处理。
+// 缓冲区满时丢弃记录并计数，绝不阻塞。
+//
+// 约束：
+// - 格式串必须是字符串字面量(记录只保存指针)
+// - 参数只支持 32 位整数/指针；%s 参数必须指向常驻内存(字面量/全局)，不支持浮点
+// - 最多 LOG_MAX_ARGS 个参数
+
+#define LOG_RING_SIZE   128     // 记录槽数(必须为2的幂)
+#define LOG_MAX_ARGS    8       // 单条记录最多参数个数；HEX 记录最多 LOG_MAX_ARGS*4 字节
+#define LOG_LINE_MAX    256     // 格式化后单条最大长度
+
+// 日志级别
+enum LogLevel {
+    LOG_LEVEL_OFF = 0,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_DEBUG
+};
+
+// 日志模块(按模块过滤)
+enum LogModule {
+    LOG_MOD_RADAR = 0,   // 雷达数据帧/视图输出
+    LOG_MOD_CMD,         // 雷达指令与 ACK
+    LOG_MOD_SYNC,        // 服务器同步
+    LOG_MOD_SYS,         // 其他
+    LOG_MOD_COUNT
+};
+
+// 日志统计
+struct LogStats {
+    uint32_t written;    // 成功写入的记录数
+    uint32_t dropped;    // 缓冲区满丢弃的记录数
+    uint32_t highWater;  // 缓冲区最高占用
+};
+
+extern uint8_t logModuleLevel[LOG_MOD_COUNT];
+
+// 初始化环形缓冲区(setup 最开始调用)
+void logInit();
+
+// 写入一条记录(由 LOG_x 宏调用)
+void logPush(uint8_t level, uint8_t module, const char* fmt, const uint32_t* args, uint8_t argc);
+
+// 写入一条 HEX 记录：prefix 后跟 len 个字节的十六进制(len 最多 LOG_MAX_ARGS*4)
+void logHex(uint8_t level, uint8_t module, const char* prefix, const uint8_t* data, uint8_t len);
+
+// 非阻塞输出：只在串口发送缓冲区有空间时格式化输出，返回输出条数
+int logDrain(int maxRecords = 8);
+
+// 阻塞输出全部记录(交互式命令/启动流程中保持输出顺序)
+void logFlush();
+
+// 是否还有未输出的记录
+bool logPending();
+
+// 暂停/恢复文本输出(二进制流模式期间串口只输出二进制记录)。暂停期间记录保留在缓冲区，
+// 满了照常丢弃计数，恢复后由 logDrain/logFlush 输出
+void logHoldOutput(bool hold);
+
+// 文本输出是否暂停；直接写 Serial 的后台输出(远程指令、WiFi 状态等)据此跳过
+bool logOutputHeld();
+
+// 设置模块日志级别，module 为 LOG_MOD_COUNT 时设置全部模块
+void logSetLevel(uint8_t module, uint8_t level);
+
+// 名称解析(控制台 log 命令用)，失败返回 -1
+int logModuleFromName(const String& name);
+int logLevelFromName(const String& name);
+
+// 获取日志统计信息
+LogStats getLogStats();
+String getLogStatusInfo();
+
+// 写入开销基准：各类记录写入环形缓冲区与推迟格式化的周期数(count 条/项)
+void runLogBench(uint32_t count);
+
+// ---- 参数打包：整数按32位保存(保留符号)，指针保存地址 ----
+template <typename T>
+inline uint32_t logArg(T v) { return (uint32_t)v; }
+
+template <typename T>
+inline uint32_t logArg(T* p) { return (uint32_t)(uintptr_t)p; }
+
+template <typename... Args>
+inline void logWrite(uint8_t level, uint8_t module, const char* fmt, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    if (level > logModuleLevel[module]) return;
+    const uint32_t packed[LOG_MAX_ARGS] = { logArg(args)... };
+    logPush(level, module, fmt, packed, sizeof...(Args));
+}
+
+#define LOG_E(mod, fmt, ...) logWrite(LOG_LEVEL_ERROR, mod, fmt, ##__VA_ARGS__)
+#define LOG_W(mod, fmt, ...) logWrite(LOG_LEVEL_WARN,  mod, fmt, ##__VA_ARGS__)
+#define LOG_I(mod, fmt, ...) logWrite(LOG_LEVEL_INFO,  mod, fmt, ##__VA_ARGS__)
+#define LOG_D(mod, fmt, ...) logWrite(LOG_LEVEL_DEBUG, mod, fmt, ##__VA_ARGS__)
+
+#endif // LOG_RING_H
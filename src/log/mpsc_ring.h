@@ -0,0 +1,76 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+// ================= 有界无锁队列 =================
+// Vyukov 有界多生产者/单消费者队列：每个槽的 seq 同步生产者与消费者，不加锁、不阻塞。
+//   生产者：reserve() 申请空槽(满时返回 NULL) -> 填写 -> commit()
+//   消费者(唯一)：front() 取队首已提交的记录 -> 使用 -> pop()
+// 不依赖 Arduino，由 test/test_mpsc_ring 在主机上检查(含多线程生产者)。
+
+template <typename T, uint32_t N>
+class MpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscRing size must be a power of 2");
+
+public:
+    MpscRing() { reset(); }
+
+    // 清空队列(没有生产者/消费者并发访问时调用)
+    void reset() {
+        for (uint32_t i = 0; i < N; i++) slots[i].seq.store(i, std::memory_order_relaxed);
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos = 0;
+    }
+
+    // 申请一个空槽，pos 用于 commit；队列满返回 NULL
+    T* reserve(uint32_t& pos) {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot* slot = &slots[pos & (N - 1)];
+            int32_t diff = (int32_t)(slot->seq.load(std::memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &slot->item;
+            } else if (diff < 0) {
+                return NULL;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 提交已填写的槽，消费者随后可见
+    void commit(uint32_t pos) {
+        slots[pos & (N - 1)].seq.store(pos + 1, std::memory_order_release);
+    }
+
+    // 队首已提交的记录；队列空或队首还在填写时返回 NULL
+    T* front() {
+        Slot* slot = &slots[dequeuePos & (N - 1)];
+        if (slot->seq.load(std::memory_order_acquire) != dequeuePos + 1) return NULL;
+        return &slot->item;
+    }
+
+    // 释放队首记录(front() 非 NULL 之后调用)
+    void pop() {
+        slots[dequeuePos & (N - 1)].seq.store(dequeuePos + N, std::memory_order_release);
+        dequeuePos++;
+    }
+
+    // 已申请未释放的槽数(含正在填写的)，只在消费者中调用
+    uint32_t used() const {
+        return enqueuePos.load(std::memory_order_relaxed) - dequeuePos;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        T item;
+    };
+    Slot slots[N];
+    std::atomic<uint32_t> enqueuePos;
+    uint32_t dequeuePos;     // 只有消费者读写
+};
+
+#endif // MPSC_RING_H
@@ -3,62 +3,45 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include "wifi/wifi_config.h"
-
-// 目标数据结构
-struct Target {
-    int16_t x;
-    int16_t y;
-    int16_t speed;
-    int16_t resolution;
-};
-
-Target targets[3];
-
-// 补充全局变量声明
-extern uint8_t radarBuf[64];
-
-// 自动检测相关全局变量
-int lastKnownMode = -1; // -1 表示未知，用于对比配置变化
-
-// 解析雷达数据并填充targets数组
-void parseTargetsFromRadarBuf() {
-    for (int i = 0; i < 3; i++) {
-        int base = 4 + i * 8;
-        uint16_t rawX = radarBuf[base] | (radarBuf[base+1]<<8);
-        uint16_t rawY = radarBuf[base+2] | (radarBuf[base+3]<<8);
-        uint16_t rawSpeed = radarBuf[base+4] | (radarBuf[base+5]<<8);
-        
-        // X坐标：最高位决定正负
-        targets[i].x = (rawX & 0x8000) ? (int16_t)(rawX - 0x8000) : -(int16_t)(rawX & 0x7FFF);
-        // Y坐标：总是正坐标，减去32768
-        targets[i].y = (int16_t)(rawY - 0x8000);
-        // 速度：最高位决定正负
-        targets[i].speed = (rawSpeed & 0x8000) ? (int16_t)(rawSpeed - 0x8000) : -(int16_t)(rawSpeed & 0x7FFF);
-        
-        targets[i].resolution = radarBuf[base+6] | (radarBuf[base+7]<<8);
-    }
-}
+#include "sync/upload_guard.h"
+#include "sync/command_channel.h"
+#include "sync/upload_task.h"
+#include "bridge/bridge_mode.h"
+#include "stream/binary_stream.h"
+#include "radar/radar_config.h"
+#include "radar/sensor_fusion.h"
+#include "analytics/heatmap.h"
+#include "analytics/trajectory.h"
+#include "pipeline/pipeline_stages.h"
+#include "capture/raw_capture.h"
+#include "log/log_ring.h"
+#include "sys/heap_telemetry.h"
+#include "sys/heap_soak_check.h"
+#include "sys/loop_events.h"
 
 // WiFi连接状态检测与自动重连
 // 注意：此函数已在wifi_config.cpp中实现，这里不再重复定义
 // void checkWiFiAndReconnect() { ... }
 
-// ================= 引脚定义 =================
-#define RX_PIN 16
-#define TX_PIN 17
-
 // ================= 全局变量 =================
-long currentBaudRate = 256000;
-bool isBaudLocked = false;
-unsigned long lastDataPrintTime = 0;
+// 雷达引脚与安装位置见 radar/radar_config.cpp
+RadarSensor* radar = NULL;   // 控制台当前操作的传感器(use <n> 切换)
+const int RADAR_FRAMES_PER_PASS = 4; // 每次循环每个传感器最多处理的帧数，避免饿死控制台
+
+unsigned long lastDataPrintTime[RADAR_MAX_SENSORS] = {0};
 const unsigned long DATA_PRINT_INTERVAL = 3000; // 3秒输出一次雷达坐标数据
 
 // raw模式限流
-unsigned long lastRawPrintTime = 0;
+unsigned long lastRawPrintTime[RADAR_MAX_SENSORS] = {0};
 const unsigned long RAW_PRINT_INTERVAL = 1000; // 1秒输出一次raw数据
 
 // 显示模式控制
-bool viewRawMode = false; // false=解析模式(默认), true=透传(Hex)模式
+enum ViewMode {
+    VIEW_PARSED = 0,   // 解析模式(默认)
+    VIEW_RAW,          // 透传(Hex)模式
+    VIEW_BINARY        // 二进制流模式(COBS帧，每帧输出)
+};
+ViewMode viewMode = VIEW_PARSED;
 
 // 自动检测相关
 unsigned long lastAutoCheckTime = 0;
@@ -71,129 +54,245 @@ bool stringComplete = false;
 // 安全确认机制变量
 bool awaitingConfirmation = false;
 String pendingCmdName = "";
-uint16_t pendingCmdWord = 0;
-uint16_t pendingCmdValInt = 0;
-uint16_t pendingCmdLen = 0; 
-
-// 雷达数据缓冲区
-const uint8_t HEAD[] = {0xAA, 0xFF, 0x03, 0x00};
-const uint8_t TAIL[] = {0x55, 0xCC};
-uint8_t radarBuf[64];
-int radarBufIdx = 0;
-
-// ================= 协议指令集 (Hex) =================
-const uint8_t CMD_HEAD[] = {0xFD, 0xFC, 0xFB, 0xFA};
-const uint8_t CMD_TAIL[] = {0x04, 0x03, 0x02, 0x01};
+const ld2450::CommandDesc* pendingCmd = NULL;
+uint8_t pendingCmdValue[ld2450::MAX_REQUEST_FRAME];
+RadarSensor* pendingSensor = NULL;
 
 // ================= 函数声明 =================
-void sendRadarPacket(uint16_t cmdWord, uint8_t* value, uint16_t valueLen);
-bool waitForAck(uint16_t sentCmd, unsigned long timeoutMs = 600, bool silent = false);
 void printHelp(bool showAll);
-void scanBaudRate();
-void parseRadarByte(uint8_t b);
-int16_t parseCoordinate(uint16_t raw);
+void handleRadarFrame(RadarSensor& s);
 void uploadDataToServer();
-
-// 核心执行函数
-void runCmd(const char* name, uint16_t cmdWord, uint8_t* val, uint16_t valLen);
-void runCmd(const char* name, uint16_t cmdWord, uint16_t valInt);
-void enableConfig(bool silent = false);
-void endConfig(bool silent = false);
-
-// [新增] 脏数据清理函数
-void clearSerialBuffer() {
-    unsigned long start = millis();
-    int cleared = 0;
-    // 持续读取直到缓冲区为空，或者超过100ms（防止死循环）
-    while ((Serial1.available() > 0) && (millis() - start < 100)) {
-        Serial1.read();
-        cleared++;
+void serviceUploadResult();
+int buildUploadPayload(String& payload, bool includeHeap);
+void handleSyncResponse(const String& resp);
+void runHeapSoak(uint32_t frames);
+bool executeRemoteCommand(const RemoteCommand& cmd);
+
+// ================= 帧处理流水线 =================
+// 阶段组合见下方 MainPipeline，可用构建开关增减(见 pipeline/pipeline_stages.h)
+
+// 输出：按显示模式输出到控制台(解析/Hex/二进制流)
+struct ConsoleViewStage : PipelineStage {
+    static constexpr const char* NAME = "console";
+    bool onFrame(FrameContext& ctx) {
+        handleRadarFrame(ctx.sensor);
+        return true;
     }
-    // 如果清理了数据，打印调试信息
-    if (cleared > 0) {
-        Serial.printf("[DEBUG] Cleared %d bytes from serial buffer\n", cleared);
+};
+
+// 输出：本轮有新帧且到达上传间隔时组装上报数据交给上传任务(上一次上传未结束则顺延)
+struct UploadStage : PipelineStage {
+    static constexpr const char* NAME = "upload";
+    void onPass(PassContext& ctx) {
+        if (ctx.frames > 0 && WiFi.status() == WL_CONNECTED && !uploadBusy() && millis() - lastUploadTime > uploadInterval) {
+            uploadDataToServer();
+            lastUploadTime = millis();
+        }
     }
-}
+};
+
+typedef FramePipeline<
+    StageIf<(PIPELINE_RANGE_FILTER_MM > 0), RangeFilterStage>,
+    ConsoleViewStage,
+    StageIf<PIPELINE_ENABLE_TRAJECTORY, TrajectoryStage>,
+    StageIf<PIPELINE_ENABLE_HEATMAP, FusionStage>,
+    StageIf<PIPELINE_ENABLE_HEATMAP, HeatmapStage>,
+    UploadStage,
+    CaptureStage
+> MainPipeline;
+
+MainPipeline framePipeline;
 
 // 危险操作请求函数
-void requestAction(const char* name, uint16_t cmdWord, uint16_t valInt, uint16_t len) {
+template <class C>
+void requestAction(const char* name, const typename C::Request& req = typename C::Request()) {
     Serial.printf("\n[!!! WARNING !!!] You are about to execute: %s\n", name);
     Serial.println("Type 'yes' to confirm, or anything else to cancel.");
     
-    // 存储挂起的命令
+    // 存储挂起的命令(命令值按描述表编码)
     pendingCmdName = String(name);
-    pendingCmdWord = cmdWord;
-    pendingCmdValInt = valInt;
-    pendingCmdLen = len; 
+    pendingCmd = &ld2450::descOf<C>();
+    ld2450::encodeValue<C>(req, pendingCmdValue);
+    pendingSensor = radar;
     awaitingConfirmation = true;
 }
 
+// 区域配置：type 0=关闭 1=仅检测区域内 2=不检测区域内，最多 3 个矩形(对角坐标 mm)，未给出的区域清零
+bool makeZoneConfig(int type, const int16_t (*rects)[4], int count, ld2450::ZoneConfig& zone) {
+    if (type < ld2450::ZONE_OFF || type > ld2450::ZONE_FILTER || count < 0 || count > LD2450_ZONE_COUNT) return false;
+    memset(&zone, 0, sizeof(zone));
+    zone.type = (uint16_t)type;
+    for (int i = 0; i < count; i++) {
+        zone.zones[i].x1 = rects[i][0];
+        zone.zones[i].y1 = rects[i][1];
+        zone.zones[i].x2 = rects[i][2];
+        zone.zones[i].y2 = rects[i][3];
+    }
+    return true;
+}
 
-// JSON封装并上传到服务器（根据当前模式动态上传目标数量）
-void uploadDataToServer() {
-    checkWiFiAndReconnect();
-    if (WiFi.status() != WL_CONNECTED) return;
-    WiFiClient client;
-    HTTPClient http;
-    http.begin(client, SERVER_URL);
-    http.addHeader("Content-Type", "application/json");
 
+// JSON封装（根据当前模式动态上传目标数量），includeHeap 时附带堆遥测
+// 单传感器时与原格式一致(坐标经安装变换)；多传感器时上传融合后的房间坐标
+// 有待上传的轨迹关键点时附带 track_points，返回附带的关键点数(上传成功后出队)
+int buildUploadPayload(String& payload, bool includeHeap) {
     // 使用新版API，消除警告
     ArduinoJson::JsonDocument doc;
     doc["device_mac"] = deviceMac;
     auto arr = doc["targets"].to<ArduinoJson::JsonArray>();
 
-    // 根据lastKnownMode判断上传目标数量
-    // 0x01=单目标，0x02=多目标，-1=未知（默认多目标）
-    int targetCount = (lastKnownMode == 0x01) ? 1 : 3;
-    for (int i = 0; i < targetCount; i++) {
-        auto obj = arr.add<ArduinoJson::JsonObject>();
-        obj["x"] = targets[i].x;
-        obj["y"] = targets[i].y;
-        obj["speed"] = targets[i].speed;
-        obj["resolution"] = targets[i].resolution;
+    if (radarSensorCount > 1) {
+        // sensors 为观测到该目标的传感器位掩码(bit0=S0)
+        FusedTarget fused[FUSION_MAX_TARGETS];
+        int n = fuseTargets(radarSensors, radarSensorCount, fused, millis());
+        for (int i = 0; i < n; i++) {
+            auto obj = arr.add<ArduinoJson::JsonObject>();
+            obj["x"] = fused[i].x;
+            obj["y"] = fused[i].y;
+            obj["speed"] = fused[i].speed;
+            obj["resolution"] = fused[i].resolution;
+            obj["sensors"] = fused[i].sensorMask;
+        }
+    } else {
+        // 根据lastKnownMode判断上传目标数量，空目标原样上传不做变换
+        RadarSensor* s = radarSensors[0];
+        for (int i = 0; i < s->targetCount(); i++) {
+            const Target& t = s->targets[i];
+            int16_t x = t.x, y = t.y;
+            if (!isEmptyTarget(t)) s->toRoom(t, x, y);
+            auto obj = arr.add<ArduinoJson::JsonObject>();
+            obj["x"] = x;
+            obj["y"] = y;
+            obj["speed"] = t.speed;
+            obj["resolution"] = t.resolution;
+        }
+    }
+    int trackPoints = 0;
+    // 断流的传感器不再送帧，由这里按时间结束其轨迹，末尾关键点随本次上传
+    trajectoryExpireTracks(millis());
+    if (trajectoryPendingPoints() > 0) {
+        trackPoints = trajectoryAppendPoints(doc["track_points"].to<ArduinoJson::JsonArray>());
+    }
+    if (includeHeap) {
+        addHeapToJson(doc["heap"].to<ArduinoJson::JsonObject>());
     }
 
-    String payload;
+    payload = "";
     serializeJson(doc, payload);
+    return trackPoints;
+}
 
-    int httpCode = http.POST(payload);
-    if (httpCode > 0) {
-        String resp = http.getString();
-        // 解析响应，动态调整上传间隔（支持加速/降频）
-        ArduinoJson::JsonDocument respDoc;
-        ArduinoJson::DeserializationError err = deserializeJson(respDoc, resp);
-        if (!err && respDoc["data"]["next_interval"]) {
-            unsigned long nextInt = respDoc["data"]["next_interval"].as<unsigned long>();
-            // 只在值变化时打印提示
-            if (nextInt != uploadInterval) {
-                if (nextInt <= 100) {
-                    Serial.println("[SYNC] 进入加速上传模式 (10Hz)");
-                } else {
-                    Serial.println("[SYNC] 切换为低频上传 (1Hz)");
-                }
+// 上传到服务器：主循环只组装 payload，HTTP 请求在上传任务中执行，结果由 serviceUploadResult() 处理
+void uploadDataToServer() {
+    HeapScope heapScope(HEAP_SUB_SYNC);
+    if (WiFi.status() != WL_CONNECTED || uploadBusy()) return;
+    // 熔断中则直接跳过
+    if (!breakerAllowRequest()) return;
+
+    uploadStats.attempts++;
+
+    // 定期附带堆遥测
+    static unsigned long lastHeapReport = 0;
+    bool includeHeap = (lastHeapReport == 0 || millis() - lastHeapReport > HEAP_REPORT_INTERVAL_MS);
+    if (includeHeap) lastHeapReport = millis();
+
+    String payload;
+    int trackPoints = buildUploadPayload(payload, includeHeap);
+    // 附带的轨迹关键点在结果返回后才出队，期间不会重复组装(上传未结束时不再提交)
+    uploadSubmit(UPLOAD_KIND_SYNC, payload, (uint32_t)trackPoints);
+}
+
+// 处理上传任务交回的结果：熔断器、上传统计、轨迹出队与响应解析都在主循环中完成
+void serviceUploadResult() {
+    UploadResult r;
+    String resp;
+    if (!uploadPollResult(r, resp)) return;
+    HeapScope heapScope(HEAP_SUB_SYNC);
+
+    if (r.ok) breakerRecordSuccess();
+    else breakerRecordFailure();
+
+    if (r.kind == UPLOAD_KIND_HEATMAP) {
+        heatmapUploadDone(r.tag, r.ok, r.httpCode);
+        return;
+    }
+
+    uploadStats.lastHttpCode = r.httpCode;
+    uploadStats.lastDurationMs = r.durationMs;
+    if (uploadStats.lastDurationMs > uploadStats.maxDurationMs) {
+        uploadStats.maxDurationMs = uploadStats.lastDurationMs;
+    }
+    if (!r.ok) {
+        uploadStats.failures++;
+        trajectoryCommitPoints(0);
+        return;
+    }
+    uploadStats.successes++;
+    trajectoryCommitPoints((int)r.tag);
+    handleSyncResponse(resp);
+}
+
+// 处理服务器响应
+void handleSyncResponse(const String& resp) {
+    // 解析响应，动态调整上传间隔（支持加速/降频）
+    ArduinoJson::JsonDocument respDoc;
+    ArduinoJson::DeserializationError err = deserializeJson(respDoc, resp);
+    if (!err && respDoc["data"]["next_interval"]) {
+        unsigned long nextInt = respDoc["data"]["next_interval"].as<unsigned long>();
+        // 只在值变化时打印提示
+        if (nextInt != uploadInterval) {
+            if (nextInt <= 100) {
+                LOG_I(LOG_MOD_SYNC, "[SYNC] 进入加速上传模式 (10Hz)\n");
+            } else {
+                LOG_I(LOG_MOD_SYNC, "[SYNC] 切换为低频上传 (1Hz)\n");
             }
-            uploadInterval = nextInt;
         }
-        // 处理pending_cmd等可扩展
-        if (!err && respDoc["data"]["pending_cmd"].is<JsonObject>()) {
-            String cmdType = respDoc["data"]["pending_cmd"]["command_type"];
-            Serial.printf("[SYNC] 执行指令: %s\n", cmdType.c_str());
-            
-            if (cmdType == "REBOOT") {
-                runCmd("Remote Reboot", 0x00A3, NULL, 0);
-            } else if (cmdType == "SET_MODE") {
-                String mode = respDoc["data"]["pending_cmd"]["payload"]["mode"];
-                if (mode == "single") {
-                    runCmd("Set Single Target", 0x0080, NULL, 0);
-                } else if (mode == "multi") {
-                    runCmd("Set Multi Target", 0x0090, NULL, 0);
-                }
-            }
-            // SET_ZONE指令标记为未来版本
+        uploadInterval = nextInt;
+    }
+    // 捎带的指令放入远程指令队列，由主循环统一执行并回报ACK
+    // pending_cmd 为旧版单条格式，pending_cmds 为批量格式
+    if (!err && respDoc["data"]["pending_cmd"].is<JsonObject>()) {
+        acceptRemoteCommand(respDoc["data"]["pending_cmd"].as<JsonObjectConst>(), COMMAND_SOURCE_SYNC);
+    }
+    if (!err && respDoc["data"]["pending_cmds"].is<JsonArray>()) {
+        for (JsonObjectConst cmd : respDoc["data"]["pending_cmds"].as<JsonArrayConst>()) {
+            acceptRemoteCommand(cmd, COMMAND_SOURCE_SYNC);
         }
     }
-    http.end();
+}
+
+// 在单个传感器上执行远程指令
+static bool executeRemoteCommandOn(RadarSensor& s, const RemoteCommand& cmd) {
+    if (strcmp(cmd.type, "REBOOT") == 0) {
+        return s.runCmd<ld2450::Reboot>("Remote Reboot");
+    } else if (strcmp(cmd.type, "SET_MODE") == 0) {
+        if (strcmp(cmd.arg, "single") == 0) {
+            return s.runCmd<ld2450::SetSingleTarget>("Set Single Target");
+        } else if (strcmp(cmd.arg, "multi") == 0) {
+            return s.runCmd<ld2450::SetMultiTarget>("Set Multi Target");
+        }
+    } else if (strcmp(cmd.type, "SET_ZONE") == 0) {
+        ld2450::ZoneConfig zone;
+        if (makeZoneConfig(cmd.zoneType, cmd.zones, cmd.zoneCount, zone)) {
+            return s.runCmd<ld2450::SetZone>("Remote Set Zone", zone);
+        }
+        if (!logOutputHeld()) Serial.printf("[SYNC] SET_ZONE 参数无效: zone_type=%d zones=%d\n", cmd.zoneType, cmd.zoneCount);
+    }
+    return false;
+}
+
+// 执行一条远程指令，返回目标传感器是否全部 ACK 成功(二进制流模式下不输出文本)
+bool executeRemoteCommand(const RemoteCommand& cmd) {
+    if (!logOutputHeld()) Serial.printf("[SYNC] 执行指令: %s\n", cmd.type);
+
+    bool ok = true;
+    int executed = 0;
+    for (int i = 0; i < radarSensorCount; i++) {
+        if (cmd.sensor >= 0 && cmd.sensor != i) continue;
+        ok = executeRemoteCommandOn(*radarSensors[i], cmd) && ok;
+        executed++;
+    }
+    return executed > 0 && ok;
 }
 
 // 批量查询当前状态，增加WiFi状态显示
@@ -218,44 +317,13 @@ void queryAllInfo() {
     } else {
         Serial.println("未知");
     }
-    runCmd("Query Version", 0x00A0, NULL, 0); delay(100); 
-    runCmd("Query MAC", 0x00A5, (uint16_t)0x0001); delay(100);
-    runCmd("Query Mode", 0x0091, NULL, 0); delay(100);
-    runCmd("Query Zone", 0x00C1, NULL, 0);
+    radar->runCmd<ld2450::QueryVersion>("Query Version"); delay(100); 
+    radar->runCmd<ld2450::QueryMac>("Query MAC"); delay(100);
+    radar->runCmd<ld2450::QueryMode>("Query Mode"); delay(100);
+    radar->runCmd<ld2450::QueryZone>("Query Zone");
     Serial.println("=== Status Report Complete ===\n");
 }
 
-// === 后台自动检测 ===
-void performAutoCheck() {
-    enableConfig(true); // 静默进入
-    delay(20); 
-    sendRadarPacket(0x0091, NULL, 0); 
-    waitForAck(0x0091, 300, true); 
-    delay(20); 
-    endConfig(true); // 静默退出
-}
-
-// === 透传桥接模式 ===
-void runBridgeMode() {
-    Serial.println("\n\n================================================");
-    Serial.println("       ENTERING TRANSPARENT BRIDGE MODE         ");
-    Serial.println("================================================");
-    Serial.println("1. ESP32 is now a USB-TTL bridge.");
-    Serial.println("2. CLOSE this Serial Monitor now.");
-    Serial.println("3. OPEN 'HLK-LD2450 Tool' and connect to this COM port.");
-    Serial.println("4. To Exit: Press the RST (Reset) button on ESP32.");
-    Serial.println("================================================\n");
-    
-    delay(100);
-    clearSerialBuffer(); // 进入前清理
-
-    while(true) {
-        if (Serial.available()) Serial1.write(Serial.read());
-        if (Serial1.available()) Serial.write(Serial1.read());
-        yield();
-    }
-}
-
 // === 发送自定义 HEX 字符串 ===
 void sendRawHex(String commandStr) {
     String hexStr = commandStr.substring(4);
@@ -270,72 +338,59 @@ void sendRawHex(String commandStr) {
         currentByte += c;
         if (currentByte.length() == 2) {
             uint8_t val = (uint8_t)strtol(currentByte.c_str(), NULL, 16);
-            Serial1.write(val);
+            radar->port().write(val);
             Serial.printf("%02X ", val);
             currentByte = "";
         }
     }
     if (currentByte.length() > 0) {
         uint8_t val = (uint8_t)strtol(currentByte.c_str(), NULL, 16);
-        Serial1.write(val);
+        radar->port().write(val);
         Serial.printf("%02X ", val);
     }
     Serial.println();
     
-    if (!viewRawMode) {
+    if (viewMode != VIEW_RAW) {
         Serial.println("(Switching to RAW view temporarily for response...)");
         unsigned long startWait = millis();
-        while(millis() - startWait < 1000) {
-            if (Serial1.available()) Serial.printf("%02X ", Serial1.read());
+        while (radar->waitRx(startWait, 1000)) {
+            Serial.printf("%02X ", radar->port().read());
         }
         Serial.println("\n(Done)");
+        radar->resetParser();
     }
 }
 
-// ================= 标准指令封装 =================
-
-void enableConfig(bool silent) {
-    uint8_t val[] = {0x01, 0x00};
-    if (!silent) Serial.print("[CMD] Enabling Config... ");
-    sendRadarPacket(0x00FF, val, 2);
-    waitForAck(0x00FF, 600, silent); 
-}
-
-void endConfig(bool silent) {
-    if (!silent) Serial.print("[CMD] Ending Config...   ");
-    sendRadarPacket(0x00FE, NULL, 0);
-    waitForAck(0x00FE, 600, silent);
-}
-
-void runCmd(const char* name, uint16_t cmdWord, uint8_t* val, uint16_t valLen) {
-    Serial.printf("\n--- Executing: %s ---\n", name);
-    
-    // [Fix] 这里的清理依然保留
-    clearSerialBuffer();
-
-    enableConfig(false);
-    delay(50);
-    
-    Serial.printf("[CMD] Sending Packet...  ");
-    sendRadarPacket(cmdWord, val, valLen);
-    waitForAck(cmdWord, 600, false); 
-    delay(50);
-    
-    endConfig(false);
-    Serial.println("--- Done ---\n");
+// 主循环是否还有未处理的输入(有则不进入等待)
+bool loopHasPendingWork() {
+    if (stringComplete || (Serial.available() && !captureDumping())) return true;
+    for (int i = 0; i < radarSensorCount; i++) {
+        if (radarSensors[i]->isBaudLocked && radarSensors[i]->hasPendingData()) return true;
+    }
+    return false;
 }
 
-void runCmd(const char* name, uint16_t cmdWord, uint16_t valInt) {
-    uint8_t valArr[2];
-    valArr[0] = (uint8_t)(valInt & 0xFF);
-    valArr[1] = (uint8_t)((valInt >> 8) & 0xFF);
-    runCmd(name, cmdWord, valArr, 2);
+// 列出全部传感器状态
+void printSensorStatus() {
+    for (int i = 0; i < radarSensorCount; i++) {
+        Serial.print(radarSensors[i] == radar ? "* " : "  ");
+        Serial.println(radarSensors[i]->getStatusInfo());
+    }
 }
 
 // ================= Setup & Loop =================
 
 void setup() {
+    loopEventsInit();
+    logInit();
+    heapTelemetryInit();
+    // 加大发送缓冲区，日志在缓冲区有空间时才输出，避免阻塞主循环
+    Serial.setTxBufferSize(1024);
     Serial.begin(256000);
+#if !ARDUINO_USB_CDC_ON_BOOT
+    // 控制台输入唤醒主循环(USB CDC 控制台依靠等待超时兜底)
+    Serial.onReceive(wakeMainLoop);
+#endif
     inputString.reserve(200);
     
     delay(1000);
@@ -343,71 +398,30 @@ void setup() {
     Serial.println("      LD2450 Radar Controller     ");
     Serial.println("==============================================");
 
-    // [优化策略] 热重启优化：先尝试256000默认波特率
-    Serial.println("Trying default 256000 baud rate for hot restart...");
-    Serial1.begin(256000, SERIAL_8N1, RX_PIN, TX_PIN);
-    delay(100);
-    clearSerialBuffer();
-    
-    // 检查是否能接收到雷达数据
-    bool radarResponding = false;
-    unsigned long startTime = millis();
-    while (millis() - startTime < 2000) { // 2秒内检查
-        if (Serial1.available()) {
-            uint8_t b = Serial1.read();
-            parseRadarByte(b);
-            if (radarBufIdx >= 30 && radarBuf[28] == TAIL[0] && radarBuf[29] == TAIL[1]) {
-                radarResponding = true;
-                break;
-            }
-        }
-    }
-    
-    if (radarResponding) {
-        Serial.println("Radar responding at 256000 baud, sending reboot command...");
-        // 发送重启命令清理状态
-        sendRadarPacket(0x00A3, NULL, 0);
-        Serial1.flush();
-        delay(2000); // 等待雷达重启
-        
-        // 重启后再次验证连接
-        clearSerialBuffer();
-        radarBufIdx = 0;
-        startTime = millis();
-        radarResponding = false;
-        while (millis() - startTime < 2000) {
-            if (Serial1.available()) {
-                uint8_t b = Serial1.read();
-                parseRadarByte(b);
-                if (radarBufIdx >= 30 && radarBuf[28] == TAIL[0] && radarBuf[29] == TAIL[1]) {
-                    radarResponding = true;
-                    break;
-                }
-            }
-        }
-        
-        if (radarResponding) {
-            Serial.println("Radar reconnected successfully at 256000 baud!");
-            currentBaudRate = 256000;
-            isBaudLocked = true;
-        } else {
-            Serial.println("Radar not responding after reboot, falling back to baud rate scan...");
-            Serial1.end();
-            scanBaudRate();
-        }
-    } else {
-        Serial.println("Radar not responding at 256000 baud, starting baud rate scan...");
-        Serial1.end();
-        scanBaudRate();
+    heatmapInit(HEATMAP_DEFAULT_CELL_MM);
+
+    // 逐个传感器热重启/扫描波特率
+    initRadarSensors();
+    radar = radarSensors[0];
+    bool anyLocked = false;
+    for (int i = 0; i < radarSensorCount; i++) {
+        anyLocked = radarSensors[i]->hotStart() || anyLocked;
     }
 
     // WiFi连接
     bool wifiConnected = initWiFi();
+    // 远程指令长轮询任务(WiFi断开时任务自行等待)
+    startCommandChannel();
+    // 数据上报/热力图上传任务
+    startUploadTask();
 
     // 雷达通信建立后，查询并显示完整信息
-    if (isBaudLocked) {
+    if (anyLocked) {
         Serial.println("\n--- System Status Report ---");
-        Serial.printf("Radar Baud Rate: %ld\n", currentBaudRate);
+        for (int i = 0; i < radarSensorCount; i++) {
+            if (radarSensors[i]->isBaudLocked) Serial.printf("Radar S%d Baud Rate: %ld\n", i, radarSensors[i]->currentBaudRate);
+            else Serial.printf("Radar S%d: not responding\n", i);
+        }
         
         if (wifiConnected) {
             Serial.println("WiFi Status: Connected");
@@ -421,13 +435,17 @@ void setup() {
         
         // 查询雷达信息
         Serial.println("\nQuerying radar information...");
-        runCmd("Query Version", 0x00A0, NULL, 0);
-        delay(200);
-        runCmd("Query MAC", 0x00A5, (uint16_t)0x0001);
-        delay(200);
-        runCmd("Query Mode", 0x0091, NULL, 0);
-        delay(200);
-        runCmd("Query Zone", 0x00C1, NULL, 0);
+        for (int i = 0; i < radarSensorCount; i++) {
+            RadarSensor* s = radarSensors[i];
+            if (!s->isBaudLocked) continue;
+            s->runCmd<ld2450::QueryVersion>("Query Version");
+            delay(200);
+            s->runCmd<ld2450::QueryMac>("Query MAC");
+            delay(200);
+            s->runCmd<ld2450::QueryMode>("Query Mode");
+            delay(200);
+            s->runCmd<ld2450::QueryZone>("Query Zone");
+        }
         
         // 保存初始配置
         Serial.println("\n--- Initial Configuration Saved ---");
@@ -436,19 +454,25 @@ void setup() {
     } else {
         Serial.println("Warning: Radar communication not established.");
         Serial.println("You may need to check connections or try manual baud rate scan.");
+        Serial.println("Ready. Type '?' for help.");
+        printHelp(false);
     }
+    logFlush();
 }
 
 void loop() {
     // 0. 定期检测WiFi连接并自动重连
     static unsigned long lastWiFiCheck = 0;
-    if (millis() - lastWiFiCheck > 5000) { // 每5秒检测一次
+    // 每5秒检测一次；连接进行中时缩短间隔以尽快推进状态(不阻塞主循环)
+    if (millis() - lastWiFiCheck > (wifiConnecting() ? WIFI_CONNECT_POLL_MS : 5000)) {
+        HeapScope heapScope(HEAP_SUB_WIFI);
         checkWiFiAndReconnect();
         lastWiFiCheck = millis();
     }
 
-    // 1. 处理 PC 串口输入
-    if (Serial.available()) {
+    // 1. 处理 PC 串口输入(读到一行为止；抓包下载期间不处理，命令输出会混进二进制内容)
+    while (!stringComplete && !captureDumping() && Serial.available()) {
+        HeapScope heapScope(HEAP_SUB_CONSOLE);
         char inChar = (char)Serial.read();
         if (inChar == '\n' || inChar == '\r') {
             if (inputString.length() > 0) stringComplete = true;
@@ -458,26 +482,25 @@ void loop() {
     }
 
     if (stringComplete) {
+        HeapScope heapScope(HEAP_SUB_CONSOLE);
+        // 交互命令的直接输出前，先刷出积压日志，保持输出顺序
+        logFlush();
         String cmd = inputString;
         cmd.trim();
         inputString = "";
         stringComplete = false;
         
         if (cmd.length() > 0) {
+
+            // 二进制流模式下串口只输出二进制记录：只接受切回文本视图的命令，其余忽略
+            if (viewMode == VIEW_BINARY && !cmd.equalsIgnoreCase("parse") && !cmd.equalsIgnoreCase("raw")) return;
             
             // --- 安全确认流程 ---
             if (awaitingConfirmation) {
                 if (cmd.equalsIgnoreCase("yes")) {
                     Serial.println(">> Confirmed. Executing...");
                     
-                    if (pendingCmdLen == 0) {
-                        runCmd(pendingCmdName.c_str(), pendingCmdWord, NULL, 0);
-                    } else {
-                        uint8_t valArr[2];
-                        valArr[0] = (uint8_t)(pendingCmdValInt & 0xFF);
-                        valArr[1] = (uint8_t)((pendingCmdValInt >> 8) & 0xFF);
-                        runCmd(pendingCmdName.c_str(), pendingCmdWord, valArr, pendingCmdLen);
-                    }
+                    pendingSensor->runCmd(*pendingCmd, pendingCmdName.c_str(), pendingCmdValue, pendingCmd->requestLen);
                     
                 } else {
                     Serial.println(">> Cancelled.");
@@ -487,8 +510,18 @@ void loop() {
             }
 
             // --- 透传/发送指令 ---
-            if (cmd.equalsIgnoreCase("bridge")) {
-                runBridgeMode(); 
+            if (cmd.equalsIgnoreCase("bridge") || cmd.startsWith("bridge ")) {
+                // 可选参数：自定义退出序列，如 bridge ~~~
+                String esc = cmd.substring(6);
+                esc.trim();
+                if (esc.length() > BRIDGE_ESCAPE_MAX) {
+                    Serial.printf("Escape sequence too long (max %d)\n", BRIDGE_ESCAPE_MAX);
+                } else {
+                    radar->clearBuffer(); // 进入前清理
+                    runBridgeMode(radar->port(), radar->currentBaudRate, esc.c_str());
+                    radar->attachErrorHandler(); // 桥接期间溢出计入桥接统计，退出后恢复传感器的计数
+                    radar->resetParser(); // 透传期间的半帧数据作废
+                }
             }
             else if (cmd.startsWith("send ")) {
                 sendRawHex(cmd);
@@ -501,60 +534,250 @@ void loop() {
                 printHelp(true);
             }
             else if (cmd.equalsIgnoreCase("scan")) {
-                scanBaudRate();
+                radar->scanBaudRate();
+                Serial.println("Ready. Type '?' for help.");
+                printHelp(false);
+            }
+            else if (cmd.equalsIgnoreCase("sensors")) {
+                printSensorStatus();
+                Serial.println(getLoopStatusInfo());
+            }
+            else if (cmd.startsWith("use ")) {
+                // use <n>：切换控制台操作的传感器
+                long n = cmd.substring(4).toInt();
+                if (cmd.substring(4).length() > 0 && n >= 0 && n < radarSensorCount) {
+                    radar = radarSensors[n];
+                    Serial.printf(">> 当前传感器: S%ld\n", n);
+                } else {
+                    Serial.printf("Usage: use <0..%d>\n", radarSensorCount - 1);
+                }
             }
             else if (cmd.equalsIgnoreCase("info")) { 
                 queryAllInfo();
             }
+            else if (cmd.equalsIgnoreCase("stats")) {
+                Serial.println(getWiFiStatusInfo());
+                Serial.println(getUploadStatusInfo());
+                Serial.println(getCommandChannelStatusInfo());
+                printSensorStatus();
+                Serial.println(getLoopStatusInfo());
+                Serial.println(getTrajectoryStatusInfo());
+                Serial.println(getCaptureStatusInfo());
+                Serial.println("[PIPELINE]");
+                framePipeline.printTiming();
+                Serial.println(getBridgeStatusInfo(radar->currentBaudRate));
+                Serial.println(getBinaryStreamStatusInfo());
+                Serial.println(getLogStatusInfo());
+                Serial.println(getHeapStatusInfo());
+            }
+            else if (cmd.equalsIgnoreCase("heatmap") || cmd.startsWith("heatmap ")) {
+                // heatmap [dump|upload|reset|cell <mm>]
+                String arg = cmd.substring(7);
+                arg.trim();
+                if (arg.equalsIgnoreCase("dump")) {
+                    // 逐片输出，每片一行
+                    String snapshot;
+                    size_t cursor = 0;
+                    uint16_t chunk = 0;
+                    bool last;
+                    do {
+                        last = heatmapBuildChunk(snapshot, cursor, chunk++);
+                        Serial.println(snapshot);
+                    } while (!last);
+                } else if (arg.equalsIgnoreCase("upload")) {
+                    heatmapUploadIfDue(true);
+                } else if (arg.equalsIgnoreCase("reset")) {
+                    heatmapReset();
+                } else if (arg.startsWith("cell ")) {
+                    if (!heatmapInit((uint16_t)arg.substring(5).toInt())) {
+                        Serial.printf("Usage: heatmap cell <%d..%d>\n", HEATMAP_MIN_CELL_MM, HEATMAP_MAX_CELL_MM);
+                    }
+                } else if (arg.length() > 0) {
+                    Serial.println("Usage: heatmap [dump|upload|reset|cell <mm>]");
+                }
+                Serial.println(getHeatmapStatusInfo());
+            }
+            else if (cmd.equalsIgnoreCase("traj") || cmd.startsWith("traj ")) {
+                // traj [err <mm>|replay [n]]，回放默认 36000 点(10Hz 一小时)
+                String arg = cmd.substring(4);
+                arg.trim();
+                if (arg.startsWith("err ")) {
+                    long mm = arg.substring(4).toInt();
+                    if (mm >= TRAJ_MIN_ERROR_MM && mm <= 1000) {
+                        trajMaxErrorMm = (uint16_t)mm;
+                    } else {
+                        Serial.printf("Usage: traj err <%d..1000>\n", TRAJ_MIN_ERROR_MM);
+                    }
+                } else if (arg.equalsIgnoreCase("replay") || arg.startsWith("replay ")) {
+                    long n = arg.length() > 7 ? arg.substring(7).toInt() : 36000;
+                    if (n > 0 && n <= TRAJ_REPLAY_MAX_SAMPLES) runTrajectoryReplay((uint32_t)n);
+                    else Serial.printf("Usage: traj replay [1..%lu]\n", (unsigned long)TRAJ_REPLAY_MAX_SAMPLES);
+                } else if (arg.length() > 0) {
+                    Serial.println("Usage: traj [err <mm>|replay [n]]");
+                }
+                Serial.println(getTrajectoryStatusInfo());
+            }
+            else if (cmd.equalsIgnoreCase("wifi") || cmd.startsWith("wifi ")) {
+                // wifi [reconnect|forget|bench [轮数]]，对比默认 5 轮
+                String arg = cmd.substring(4);
+                arg.trim();
+                if (arg.equalsIgnoreCase("reconnect")) {
+                    WiFi.disconnect();
+                    checkWiFiAndReconnect();
+                } else if (arg.equalsIgnoreCase("forget")) {
+                    wifiForgetCache();
+                } else if (arg.equalsIgnoreCase("bench") || arg.startsWith("bench ")) {
+                    long n = arg.length() > 6 ? arg.substring(6).toInt() : 5;
+                    if (n > 0 && n <= WIFI_BENCH_MAX_ROUNDS) runWiFiBench((uint32_t)n);
+                    else Serial.printf("Usage: wifi bench [1..%d] (blocks radar ingest, up to ~12 s per round)\n", WIFI_BENCH_MAX_ROUNDS);
+                } else if (arg.length() > 0) {
+                    Serial.println("Usage: wifi [reconnect|forget|bench [n]]");
+                }
+                Serial.println(getWiFiStatusInfo());
+            }
+            else if (cmd.equalsIgnoreCase("capture") || cmd.startsWith("capture ")) {
+                // capture [start [刷新间隔s]|stop|dump|bench [块数]]
+                String arg = cmd.substring(7);
+                arg.trim();
+                if (arg.equalsIgnoreCase("start") || arg.startsWith("start ")) {
+                    long flushS = arg.length() > 6 ? arg.substring(6).toInt() : CAPTURE_DEFAULT_FLUSH_S;
+                    if (flushS < 0 || flushS > 3600) Serial.println("Usage: capture start [flush_s 0..3600]");
+                    else if (!captureStart(radarSensors, radarSensorCount, (uint16_t)flushS)) Serial.println("Capture start failed");
+                } else if (arg.equalsIgnoreCase("stop")) {
+                    captureStop();
+                } else if (arg.equalsIgnoreCase("dump")) {
+                    captureDump();
+                    if (captureDumping()) return;   // 下载内容由主循环逐段输出，不再打印状态
+                } else if (arg.equalsIgnoreCase("bench") || arg.startsWith("bench ")) {
+                    long n = arg.length() > 6 ? arg.substring(6).toInt() : CAPTURE_BENCH_MAX_BLOCKS;
+                    if (n > 0 && n <= CAPTURE_BENCH_MAX_BLOCKS) runCaptureBench((uint32_t)n);
+                    else Serial.printf("Usage: capture bench [1..%d] (overwrites the saved capture)\n", CAPTURE_BENCH_MAX_BLOCKS);
+                } else if (arg.length() > 0) {
+                    Serial.println("Usage: capture [start [flush_s]|stop|dump|bench [n]]");
+                }
+                Serial.println(getCaptureStatusInfo());
+            }
+            else if (cmd.equalsIgnoreCase("pipeline") || cmd.startsWith("pipeline ")) {
+                // pipeline [reset|bench [帧数]]，基准默认 100000 帧
+                String arg = cmd.substring(8);
+                arg.trim();
+                if (arg.equalsIgnoreCase("reset")) {
+                    framePipeline.resetTiming();
+                } else if (arg.equalsIgnoreCase("bench") || arg.startsWith("bench ")) {
+                    long frames = arg.length() > 6 ? arg.substring(6).toInt() : 100000;
+                    if (frames > 0 && frames <= 1000000) runPipelineBench((uint32_t)frames);
+                    else Serial.println("Usage: pipeline bench [1..1000000]");
+                } else if (arg.length() > 0) {
+                    Serial.println("Usage: pipeline [reset|bench [n]]");
+                }
+                framePipeline.printTiming();
+            }
+            else if (cmd.equalsIgnoreCase("soak") || cmd.startsWith("soak ")) {
+                // soak [帧数]，默认 1000000
+                long frames = cmd.length() > 5 ? cmd.substring(5).toInt() : 1000000;
+                if (frames > 0) runHeapSoak((uint32_t)frames);
+                else Serial.println("Usage: soak [frames]");
+            }
+            else if (cmd.equalsIgnoreCase("log") || cmd.startsWith("log ")) {
+                // log <模块|all> <级别>，如 log radar warn；log bench [n] 测写入开销，默认每项 10000 条
+                String args = cmd.substring(3);
+                args.trim();
+                int sp = args.indexOf(' ');
+                if (args.equalsIgnoreCase("bench") || args.startsWith("bench ")) {
+                    long n = args.length() > 6 ? args.substring(6).toInt() : 10000;
+                    if (n > 0 && n <= 1000000) runLogBench((uint32_t)n);
+                    else Serial.println("Usage: log bench [1..1000000]");
+                }
+                else if (sp > 0) {
+                    String modName = args.substring(0, sp);
+                    String lvlName = args.substring(sp + 1);
+                    lvlName.trim();
+                    int mod = logModuleFromName(modName);
+                    int lvl = logLevelFromName(lvlName);
+                    if (mod >= 0 && lvl >= 0) logSetLevel(mod, lvl);
+                    else Serial.println("Usage: log <radar|cmd|sync|sys|all> <off|error|warn|info|debug>");
+                }
+                Serial.println(getLogStatusInfo());
+            }
             // === 视图切换指令 ===
             else if (cmd.equalsIgnoreCase("raw")) {
-                viewRawMode = true;
+                logHoldOutput(false);
+                viewMode = VIEW_RAW;
                 Serial.println("\n>>> 已切换为【透传模式】(Hex View) <<<");
             }
             else if (cmd.equalsIgnoreCase("parse")) {
-                viewRawMode = false;
+                logHoldOutput(false);   // 离开二进制流模式，积压日志随后输出
+                viewMode = VIEW_PARSED;
                 Serial.println("\n>>> 已切换为【解析模式】(Parsed View) <<<");
             }
+            else if (cmd.equalsIgnoreCase("bin")) {
+                Serial.println("\n>>> 已切换为【二进制流模式】(COBS) 输入 parse 返回 <<<");
+                Serial.flush();
+                // 之后的日志留在缓冲区，返回文本视图时再输出
+                logHoldOutput(true);
+                viewMode = VIEW_BINARY;
+            }
             // ===================
             else if (cmd.equalsIgnoreCase("ver")) {
-                runCmd("Query Version", 0x00A0, NULL, 0);
+                radar->runCmd<ld2450::QueryVersion>("Query Version");
             }
             else if (cmd.equalsIgnoreCase("mac")) {
-                runCmd("Query MAC", 0x00A5, (uint16_t)0x0001); 
+                radar->runCmd<ld2450::QueryMac>("Query MAC"); 
             }
             else if (cmd.equalsIgnoreCase("zone")) {
-                runCmd("Query Zone", 0x00C1, NULL, 0);
+                radar->runCmd<ld2450::QueryZone>("Query Zone");
             }
             else if (cmd.equalsIgnoreCase("mode")) {
-                runCmd("Query Mode", 0x0091, NULL, 0);
+                radar->runCmd<ld2450::QueryMode>("Query Mode");
             }
             
             // === 配置指令 ===
             else if (cmd.equalsIgnoreCase("set single")) {
-                runCmd("Set Single Target", 0x0080, NULL, 0);
+                radar->runCmd<ld2450::SetSingleTarget>("Set Single Target");
             }
             else if (cmd.equalsIgnoreCase("set multi")) {
-                runCmd("Set Multi Target", 0x0090, NULL, 0);
+                radar->runCmd<ld2450::SetMultiTarget>("Set Multi Target");
+            }
+            else if (cmd.startsWith("zone set ")) {
+                // zone set <type> [x1 y1 x2 y2]...，最多 3 个区域
+                int type = -1;
+                int v[LD2450_ZONE_COUNT * 4 + 1];
+                int n = sscanf(cmd.c_str() + 9, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d", &type,
+                               &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9], &v[10], &v[11], &v[12]);
+                int16_t rects[LD2450_ZONE_COUNT][4];
+                int count = (n - 1) / 4;
+                for (int i = 0; i < count && i < LD2450_ZONE_COUNT; i++) {
+                    for (int k = 0; k < 4; k++) rects[i][k] = (int16_t)constrain(v[i * 4 + k], -32768, 32767);
+                }
+                ld2450::ZoneConfig zone;
+                if (n >= 1 && (n - 1) % 4 == 0 && makeZoneConfig(type, rects, count, zone)) {
+                    radar->runCmd<ld2450::SetZone>("Set Zone", zone);
+                } else {
+                    Serial.println("Usage: zone set <0|1|2> [x1 y1 x2 y2] ... (最多 3 个区域)");
+                }
             }
             else if (cmd.equalsIgnoreCase("bleon")) {
-                runCmd("BLE ON", 0x00A4, (uint16_t)0x0001);
+                radar->runCmd<ld2450::SetBluetooth>("BLE ON", {0x0001});
             }
             else if (cmd.equalsIgnoreCase("bleoff")) {
-                runCmd("BLE OFF", 0x00A4, (uint16_t)0x0000);
+                radar->runCmd<ld2450::SetBluetooth>("BLE OFF", {0x0000});
+            }
+            else if (cmd.equalsIgnoreCase("proto")) {
+                ld2450::printCommandTable();
             }
             
             // === 危险指令 ===
             else if (cmd.equalsIgnoreCase("reboot")) {
-                requestAction("Reboot Module", 0x00A3, 0, 0); 
+                requestAction<ld2450::Reboot>("Reboot Module"); 
             }
             else if (cmd.equalsIgnoreCase("factory")) {
-                requestAction("Factory Reset", 0x00A2, 0, 0); 
+                requestAction<ld2450::FactoryReset>("Factory Reset"); 
             }
             else if (cmd.startsWith("baud")) {
                 if (cmd.indexOf("256000") != -1) {
-                    requestAction("Set Baud 256000", 0x00A1, 0x0007, 2); 
+                    requestAction<ld2450::SetBaudRate>("Set Baud 256000", {ld2450::BAUD_256000}); 
                 } else if (cmd.indexOf("115200") != -1) {
-                    requestAction("Set Baud 115200", 0x00A1, 0x0005, 2); 
+                    requestAction<ld2450::SetBaudRate>("Set Baud 115200", {ld2450::BAUD_115200}); 
                 } else {
                     Serial.println("Usage: baud 256000");
                 }
@@ -565,43 +788,221 @@ void loop() {
         }
     }
 
+    // 1.5 执行远程指令(长轮询/捎带投递的一批指令依次执行并回报ACK)
+    RemoteCommand remoteCmd;
+    while (popRemoteCommand(remoteCmd)) {
+        HeapScope heapScope(HEAP_SUB_CMD);
+        unsigned long execStart = millis();
+        bool ok = executeRemoteCommand(remoteCmd);
+        reportCommandAck(remoteCmd, ok, execStart);
+    }
+    // 1.6 上传任务交回的结果
+    serviceUploadResult();
+
     // 2. 自动检测逻辑
-    if (!viewRawMode && isBaudLocked && millis() - lastAutoCheckTime > AUTO_CHECK_INTERVAL) {
-        performAutoCheck();
+    if (viewMode == VIEW_PARSED && millis() - lastAutoCheckTime > AUTO_CHECK_INTERVAL) {
+        for (int i = 0; i < radarSensorCount; i++) {
+            if (radarSensors[i]->isBaudLocked) radarSensors[i]->performAutoCheck();
+        }
         lastAutoCheckTime = millis();
     }
 
-    // 3. 处理雷达数据流
-    if (isBaudLocked && Serial1.available()) {
-        uint8_t b = Serial1.read();
-        parseRadarByte(b);
-
-        // 检查是否完整帧并上报
-        if (radarBufIdx == 0 && WiFi.status() == WL_CONNECTED) {
-            parseTargetsFromRadarBuf();
-            if (millis() - lastUploadTime > uploadInterval) {
-                uploadDataToServer();
-                lastUploadTime = millis();
+    // 3. 处理雷达数据流：每个传感器块读取串口缓冲，每帧交给流水线，
+    //    一轮结束后流水线做融合/热力图/上传
+    PassContext pass;
+    pass.sensors = radarSensors;
+    pass.sensorCount = radarSensorCount;
+    pass.frames = 0;
+    pass.fusedCount = 0;
+    {
+        HeapScope heapScope(HEAP_SUB_RADAR);
+        for (int i = 0; i < radarSensorCount; i++) {
+            RadarSensor& s = *radarSensors[i];
+            if (!s.isBaudLocked) continue;
+            for (int f = 0; f < RADAR_FRAMES_PER_PASS && s.poll(); f++) {
+                FrameContext ctx = {s, (uint32_t)millis()};
+                framePipeline.processFrame(ctx);
+                pass.frames++;
             }
         }
     }
+    pass.now = millis();
+    framePipeline.endPass(pass);
+
+    // 4. 低优先级：在串口发送缓冲区有空间时格式化输出积压日志
+    logDrain();
+
+    // 5. 无待处理数据时阻塞等待雷达/控制台/远程指令事件，期间让出核心1
+    if (!loopHasPendingWork()) {
+        waitLoopEvent(logPending() || captureDumping() ? LOOP_LOG_RETRY_MS : LOOP_IDLE_TIMEOUT_MS);
+    }
 }
 
 // ================= 辅助功能函数 =================
 
+// 多传感器时 RAW 输出的前缀(日志延迟格式化，须为静态字符串)
+static const char* const RAW_PREFIX[RADAR_MAX_SENSORS] = {"RAW S0: ", "RAW S1: ", "RAW S2: "};
+static const char* const TARGET_PREFIX[RADAR_MAX_SENSORS] = {"S0 Target: ", "S1 Target: ", "S2 Target: "};
+
+// 解析视图：按有目标的槽位(bit0=T1)选择格式串，整帧只写一条日志记录，
+// 缓冲区满时整帧丢弃，不会只留下半行
+static const char* const TARGET_FMT[1 << RADAR_MAX_TARGETS] = {
+    NULL,
+    "%s[T1 %d,%d] \n",
+    "%s[T2 %d,%d] \n",
+    "%s[T1 %d,%d] [T2 %d,%d] \n",
+    "%s[T3 %d,%d] \n",
+    "%s[T1 %d,%d] [T3 %d,%d] \n",
+    "%s[T2 %d,%d] [T3 %d,%d] \n",
+    "%s[T1 %d,%d] [T2 %d,%d] [T3 %d,%d] \n"
+};
+
+// 完整数据帧：按当前视图输出
+void handleRadarFrame(RadarSensor& s) {
+    if (viewMode == VIEW_BINARY) {
+        streamFrameRecord(s.id, s.targets, s.targetCount());
+    }
+    else if (viewMode == VIEW_RAW) {
+        if (millis() - lastRawPrintTime[s.id] > RAW_PRINT_INTERVAL) {
+            logHex(LOG_LEVEL_INFO, LOG_MOD_RADAR, radarSensorCount > 1 ? RAW_PREFIX[s.id] : "RAW: ", s.frame(), RADAR_FRAME_LEN);
+            lastRawPrintTime[s.id] = millis();
+        } else {
+            if (millis() % 500 < 20 && millis() % 100 == 0) LOG_D(LOG_MOD_RADAR, "🔄\n");
+        }
+    }
+    else if (viewMode == VIEW_PARSED) {
+        if (millis() - lastDataPrintTime[s.id] > DATA_PRINT_INTERVAL) {
+            // 根据雷达模式决定输出目标数量
+            int mask = 0;
+            int32_t xy[RADAR_MAX_TARGETS * 2] = {0};
+            int n = 0;
+            for (int i = 0; i < s.targetCount(); i++) {
+                const Target& t = s.targets[i];
+                if (t.x != 0 || t.y != 0) {
+                    mask |= 1 << i;
+                    xy[n++] = t.x;
+                    xy[n++] = t.y;
+                }
+            }
+            if (mask != 0) {
+                LOG_I(LOG_MOD_RADAR, TARGET_FMT[mask], radarSensorCount > 1 ? TARGET_PREFIX[s.id] : "Target: ",
+                      xy[0], xy[1], xy[2], xy[3], xy[4], xy[5]);
+            } else {
+                LOG_I(LOG_MOD_RADAR, ".");
+            }
+            lastDataPrintTime[s.id] = millis();
+        } else { 
+            if (millis() % 500 < 20 && millis() % 100 == 0) LOG_D(LOG_MOD_RADAR, "[❤️ ]\n"); 
+        }
+    }
+}
+
+// === 加速浸泡测试 ===
+// 以最快速度回放合成雷达帧，走完整的帧解析、上传JSON组装与响应解析路径(不联网)，
+// 检查空闲堆、最大空闲块与峰值占用是否保持平稳(判定见 sys/heap_soak_check.h)
+
+void runHeapSoak(uint32_t frames) {
+    // 官方数据样例帧：目标1 (-272mm, 850mm)
+    uint8_t frame[30] = {
+        0xAA, 0xFF, 0x03, 0x00,
+        0x10, 0x01, 0x52, 0x83, 0x00, 0x00, 0x68, 0x01,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x55, 0xCC
+    };
+    char resp[64];
+    snprintf(resp, sizeof(resp), "{\"data\":{\"next_interval\":%lu}}", uploadInterval);
+
+    Serial.printf("\n--- Heap Soak: %lu frames ---\n", (unsigned long)frames);
+    Serial.println(getHeapStatusInfo());
+    logFlush();
+
+    // 回放走 S0 的解析器，结束后恢复其指标，避免污染帧率统计
+    RadarSensor* s0 = radarSensors[0];
+    RadarMetrics savedMetrics = s0->metrics;
+    s0->resetParser();
+    HeapSnapshot before = takeHeapSnapshot();
+    HeapSoakCheck check;
+    check.begin(before.freeHeap, before.largestBlock);
+    String payload;
+    unsigned long start = millis();
+
+    for (uint32_t i = 0; i < frames; i++) {
+        // 目标1的X坐标随帧变化，覆盖不同长度的数字
+        uint16_t rawX = 0x8000 | (i % 6000);
+        frame[4] = rawX & 0xFF;
+        frame[5] = (rawX >> 8) & 0xFF;
+        {
+            HeapScope heapScope(HEAP_SUB_RADAR);
+            for (int k = 0; k < (int)sizeof(frame); k++) {
+                s0->parseByte(frame[k]);
+            }
+        }
+        {
+            HeapScope heapScope(HEAP_SUB_SYNC);
+            buildUploadPayload(payload, false);
+            handleSyncResponse(resp);
+        }
+        logDrain();
+
+        if ((i + 1) % 10000 == 0) {
+            HeapSnapshot s = takeHeapSnapshot();
+            check.sample(i >= frames / 2, s.freeHeap, s.largestBlock);
+            if ((i + 1) % 100000 == 0) {
+                Serial.printf("  %lu frames  free=%lu largest=%lu frag=%u%%\n",
+                              (unsigned long)(i + 1), (unsigned long)s.freeHeap, (unsigned long)s.largestBlock, s.fragPct);
+            }
+            vTaskDelay(1); // 让出CPU，避免看门狗
+        }
+    }
+
+    unsigned long elapsed = millis() - start;
+    s0->metrics = savedMetrics;
+    for (int i = 0; i < radarSensorCount; i++) {
+        radarSensors[i]->resetParser();
+        radarSensors[i]->clearBuffer(); // 浸泡期间积压的雷达数据作废
+    }
+    logFlush();
+
+    HeapSnapshot after = takeHeapSnapshot();
+    bool pass = check.finish(after.freeHeap, after.largestBlock);
+
+    Serial.printf("Soak done: %lu frames in %lu ms (%lu frames/s)\n", (unsigned long)frames, elapsed,
+                  elapsed ? (unsigned long)((uint64_t)frames * 1000 / elapsed) : 0);
+    Serial.printf("  free delta=%ld  largest delta=%ld  min largest=%lu\n", (long)check.freeDelta, (long)check.largestDelta,
+                  (unsigned long)check.minLargest);
+    Serial.printf("  peak usage: first half=%ld  second half=%ld\n", (long)check.peakFirst, (long)check.peakSecond);
+    Serial.println(getHeapStatusInfo());
+    Serial.println(pass ? ">> SOAK PASS: heap flat" : ">> SOAK FAIL: heap drift/fragmentation detected");
+    Serial.println("--- Done ---\n");
+}
+
 void printHelp(bool showAll) {
     Serial.println("\n\n================ LD2450 安全控制台 ================");
     Serial.println(" [提示] 输入命令后按回车发送");
     Serial.println(" [自动] 系统每15秒会自动检查一次配置(仅在解析模式下)。");
     
     Serial.println("\n--- 透传与连接 ---");
-    Serial.printf("  %-14s : %s\n", "bridge", "【桥接】进入透明传输模式 (连接官方上位机用)");
+    Serial.printf("  %-14s : %s\n", "bridge [esc]", "【桥接】进入透明传输模式 (连接官方上位机用，静默1秒后输入 +++ 退出)");
     Serial.printf("  %-14s : %s\n", "raw", "【查看】显示原始 Hex 数据 (无延迟)");
     Serial.printf("  %-14s : %s\n", "parse", "【查看】显示解析后的坐标 (3秒一次)");
+    Serial.printf("  %-14s : %s\n", "bin", "【查看】二进制流 (COBS帧，每帧输出，配合 tools/binary_stream_decoder.py)");
     Serial.printf("  %-14s : %s\n", "send <hex>", "【发送】发送原始 HEX (如: send FD FC ...)");
 
     Serial.println("\n--- 调试工具 ---");
     Serial.printf("  %-14s : %s\n", "info", "一键查询所有状态");
+    Serial.printf("  %-14s : %s\n", "sensors", "列出所有雷达传感器的波特率/帧率/丢帧率/安装位置");
+    Serial.printf("  %-14s : %s\n", "use <n>", "切换控制台操作的传感器 (如: use 1)");
+    Serial.printf("  %-14s : %s\n", "wifi [..]", "WiFi 状态与连接耗时分布；reconnect 断开重连，forget 清除快速重连缓存，bench [n] 对比快速连接与全扫描(阻塞，期间雷达摄入停顿)");
+    Serial.printf("  %-14s : %s\n", "stats", "查看上传/熔断器/远程指令延迟统计");
+    Serial.printf("  %-14s : %s\n", "log <mod> <lv>", "设置模块日志级别 (如: log radar warn)");
+    Serial.printf("  %-14s : %s\n", "log bench [n]", "测量日志写入环形缓冲区与推迟格式化的周期数");
+    Serial.printf("  %-14s : %s\n", "heatmap [..]", "占用热力图状态；dump 输出快照，upload 立即上传，reset 清零，cell <mm> 改格子大小");
+    Serial.printf("  %-14s : %s\n", "traj [..]", "轨迹压缩状态；err <mm> 设最大误差，replay [n] 回放合成轨迹并报告压缩比/误差");
+    Serial.printf("  %-14s : %s\n", "capture [..]", "原始串口字节抓包到 flash；start [s] 开始(s 为刷新间隔)，stop 停止，dump 串口下载(配合 tools/capture_tool.py，下载期间不接受命令)，bench [n≤256] 测 flash 擦写吞吐(覆盖已保存的抓包)");
+    Serial.printf("  %-14s : %s\n", "pipeline [..]", "帧处理流水线阶段与计时；reset 清零计时，bench [n] 对比组合流水线与手写循环的每帧耗时");
+    Serial.printf("  %-14s : %s\n", "proto", "列出 LD2450 指令描述表");
+    Serial.printf("  %-14s : %s\n", "soak [n]", "加速浸泡测试：回放n帧并检查堆碎片 (默认100万帧)");
 
     Serial.println("\n--- 状态查询 ---");
     Serial.printf("  %-14s : %s\n", "mode", "查询当前追踪模式");
@@ -610,6 +1011,7 @@ void printHelp(bool showAll) {
     Serial.println("\n--- 配置修改 ---");
     Serial.printf("  %-14s : %s\n", "set single", "切换为单目标模式");
     Serial.printf("  %-14s : %s\n", "set multi", "切换为多目标模式");
+    Serial.printf("  %-14s : %s\n", "zone set <t> ..", "设置区域过滤 (t: 0关 1检测 2过滤，后跟最多3组 x1 y1 x2 y2)");
     Serial.printf("  %-14s : %s\n", "bleon / bleoff", "开关蓝牙");
 
     Serial.println("\n--- 危险操作 (需确认) ---");
@@ -619,239 +1021,3 @@ void printHelp(bool showAll) {
     Serial.println("注: Target: [T1 x,y] 表示目标1的[X左右方向角度坐标] [Y距离坐标，单位为毫米]");
     Serial.println();
 }
-
-void sendRadarPacket(uint16_t cmdWord, uint8_t* value, uint16_t valueLen) {
-    uint16_t dataLen = 2 + valueLen;
-    Serial1.write(CMD_HEAD, 4);
-    Serial1.write((uint8_t)(dataLen & 0xFF));
-    Serial1.write((uint8_t)((dataLen >> 8) & 0xFF));
-    Serial1.write((uint8_t)(cmdWord & 0xFF));
-    Serial1.write((uint8_t)((cmdWord >> 8) & 0xFF));
-    if (valueLen > 0 && value != NULL) Serial1.write(value, valueLen);
-    Serial1.write(CMD_TAIL, 4);
-}
-
-// 智能 ACK 解析函数 (支持 silent 模式)
-bool waitForAck(uint16_t sentCmd, unsigned long timeoutMs, bool silent) {
-    unsigned long start = millis();
-    uint8_t ackBuf[64]; 
-    int ackIdx = 0;
-    
-    while (millis() - start < timeoutMs) {
-        if (Serial1.available()) {
-            uint8_t b = Serial1.read();
-            if (ackIdx < (int)sizeof(ackBuf)) ackBuf[ackIdx++] = b;
-            
-            if (ackIdx >= 10 && 
-                ackBuf[ackIdx-4] == 0x04 && ackBuf[ackIdx-3] == 0x03 && 
-                ackBuf[ackIdx-2] == 0x02 && ackBuf[ackIdx-1] == 0x01) {
-                
-                if (ackBuf[0] == 0xFD && ackBuf[1] == 0xFC) {
-                     uint16_t status = ackBuf[8] | (ackBuf[9] << 8);
-                     if (status != 0) {
-                         if(!silent) Serial.printf("FAILED (Err: 0x%04X)\n", status);
-                         return false;
-                     }
-                     
-                     if (sentCmd == 0x00A4) {
-                         Serial.println("SUCCESS -> Bluetooth config saved.");
-                         Serial.println(">> NOTICE: Please execute 'reboot' command to apply changes! <<");
-                     }
-                     else if (sentCmd == 0x0091) { // mode
-                         uint16_t mode = ackBuf[10] | (ackBuf[11] << 8);
-                         
-                         if (!silent) {
-                             Serial.printf("SUCCESS -> Mode: %s\n", (mode == 0x02) ? "Multi Target" : "Single Target");
-                         }
-                         else {
-                             if (lastKnownMode != -1 && mode != lastKnownMode) {
-                                 Serial.println("\n\n-----------------------------------------");
-                                 Serial.printf("[Auto-Check] ALERT: Mode Changed to %s!\n", (mode == 0x02) ? "Multi" : "Single");
-                                 Serial.println("-----------------------------------------\n");
-                             }
-                         }
-                         lastKnownMode = mode;
-                     }
-                     else if (!silent) {
-                         if (sentCmd == 0x00A0) { // ver
-                             uint16_t major = ackBuf[12] | (ackBuf[13] << 8);
-                             uint32_t minor = ackBuf[14] | (ackBuf[15] << 8) | (ackBuf[16] << 16) | (ackBuf[17] << 24);
-                             Serial.printf("SUCCESS -> Firmware: V%x.%02x.%08X\n", (major>>8), (major&0xFF), minor);
-                         }
-                         else if (sentCmd == 0x00A5) { // mac
-                             Serial.printf("SUCCESS -> MAC: %02X:%02X:%02X:%02X:%02X:%02X\n", 
-                                ackBuf[10], ackBuf[11], ackBuf[12], ackBuf[13], ackBuf[14], ackBuf[15]);
-                         }
-                         else if (sentCmd == 0x00C1) { // zone
-                             uint16_t zType = ackBuf[10] | (ackBuf[11] << 8);
-                             Serial.printf("SUCCESS -> Zone: Type=%d (0:Off, 1:Det, 2:Filt)\n", zType);
-                             for (int i=0; i<3; i++) {
-                                 int base = 12 + i*8;
-                                 int16_t x1 = ackBuf[base] | (ackBuf[base+1]<<8);
-                                 int16_t y1 = ackBuf[base+2] | (ackBuf[base+3]<<8);
-                                 int16_t x2 = ackBuf[base+4] | (ackBuf[base+5]<<8);
-                                 int16_t y2 = ackBuf[base+6] | (ackBuf[base+7]<<8);
-                                 Serial.printf("           Z%d: (%d,%d)-(%d,%d)\n", i+1, x1, y1, x2, y2);
-                             }
-                         }
-                         else if (sentCmd == 0x00FF) Serial.println("ENABLED");
-                         else if (sentCmd == 0x00FE) Serial.println("ENDED");
-                         else Serial.println("SUCCESS");
-                     }
-                     return true;
-                }
-                ackIdx = 0; 
-            }
-        }
-    }
-    if(!silent) Serial.println("TIMEOUT");
-    return false;
-}
-
-// 扫描波特率逻辑 (增加清洗)
-void scanBaudRate() {
-    isBaudLocked = false;
-    const long RATES[] = {256000, 115200}; 
-    int numRates = sizeof(RATES) / sizeof(RATES[0]);
-    
-    Serial.println("\n--- Scanning Baud Rate ---");
-
-    int retryCount = 0;
-    const int MAX_RETRIES = 5; // 最多重试5次
-
-    while(!isBaudLocked && retryCount < MAX_RETRIES) {
-        for (int i = 0; i < numRates; i++) {
-            long rate = RATES[i];
-            Serial.printf("Trying %ld... ", rate);
-            
-            Serial1.end();
-            delay(200); // 增加关闭等待时间
-            
-            Serial1.setRxBufferSize(2048);
-            Serial1.begin(rate, SERIAL_8N1, RX_PIN, TX_PIN);
-            
-            // [增强] 多重清理策略
-            delay(200); // 等待串口稳定
-            clearSerialBuffer(); // 清理当前缓冲区
-            delay(300); // 额外等待，让雷达的旧数据流逝
-            
-            // [增强] 再次清理，确保缓冲区干净
-            clearSerialBuffer();
-            
-            unsigned long scanStart = millis();
-            int matchCount = 0;
-            int cfgMatchCount = 0;
-            bool found = false;
-            int bytesReceived = 0;
-            
-            while (millis() - scanStart < 2000) { // 增加扫描时间到2秒
-                if (Serial1.available()) {
-                    uint8_t b = Serial1.read();
-                    bytesReceived++;
-                    
-                    if (matchCount == 0 && b == 0xAA) matchCount++;
-                    else if (matchCount == 1 && b == 0xFF) matchCount++;
-                    else if (matchCount == 2 && b == 0x03) matchCount++;
-                    else if (matchCount == 3 && b == 0x00) { found = true; break; }
-                    else { if (b == 0xAA) matchCount = 1; else matchCount = 0; }
-                    
-                    if (cfgMatchCount == 0 && b == 0xFD) cfgMatchCount++;
-                    else if (cfgMatchCount == 1 && b == 0xFC) cfgMatchCount++;
-                    else if (cfgMatchCount == 2 && b == 0xFB) cfgMatchCount++;
-                    else if (cfgMatchCount == 3 && b == 0xFA) { found = true; break; }
-                    else { if (b == 0xFD) cfgMatchCount = 1; else cfgMatchCount = 0; }
-                }
-            }
-            
-            if (found) {
-                Serial.printf("LOCKED! (received %d bytes)\n", bytesReceived);
-                currentBaudRate = rate;
-                isBaudLocked = true;
-                Serial.println("Ready. Type '?' for help.");
-                printHelp(false);
-                return;
-            } else {
-                Serial.printf("No (%d bytes received)\n", bytesReceived);
-            }
-        }
-        
-        retryCount++;
-        if (retryCount < MAX_RETRIES) {
-            Serial.printf("\nScan failed. Auto-retrying in 3 seconds... (attempt %d/%d)\n", retryCount + 1, MAX_RETRIES);
-            Serial.println("(Press any key to stop scanning and enter console)");
-            
-            unsigned long waitStart = millis();
-            while(millis() - waitStart < 3000) {
-                if (Serial.available()) {
-                    Serial.println("\n>> Scan aborted by user.");
-                    isBaudLocked = true; 
-                    return;
-                }
-            }
-            Serial.println("\n--- Retrying Scan ---");
-        }
-    }
-    
-    if (!isBaudLocked) {
-        Serial.println("\n>> Maximum retries exceeded. Entering console mode anyway.");
-        Serial.println("You may need to manually reset or check radar connection.");
-        Serial.println("Ready. Type '?' for help.");
-        printHelp(false);
-    }
-}
-
-void parseRadarByte(uint8_t b) {
-    if (radarBufIdx < 4) {
-        if (b == HEAD[radarBufIdx]) radarBuf[radarBufIdx++] = b;
-        else {
-            if (b == HEAD[0]) { radarBuf[0] = b; radarBufIdx = 1; }
-            else radarBufIdx = 0;
-        }
-    } else {
-        radarBuf[radarBufIdx++] = b;
-        if (radarBufIdx >= 64) radarBufIdx = 0;
-        
-        if (radarBufIdx >= 30 && radarBuf[28] == TAIL[0] && radarBuf[29] == TAIL[1]) {
-            if (viewRawMode) {
-                if (millis() - lastRawPrintTime > RAW_PRINT_INTERVAL) {
-                    Serial.print("RAW: ");
-                    for (int i = 0; i < radarBufIdx; i++) {
-                        Serial.printf("%02X ", radarBuf[i]);
-                    }
-                    Serial.println();
-                    lastRawPrintTime = millis();
-                } else {
-                    if (millis() % 500 < 20 && millis() % 100 == 0) Serial.print("🔄\n");
-                }
-            }
-            else {
-                if (millis() - lastDataPrintTime > DATA_PRINT_INTERVAL) {
-                    String output = "Target: ";
-                    bool hasTarget = false;
-                    // 根据雷达模式决定输出目标数量
-                    // 0x01=单目标，0x02=多目标，-1=未知（默认多目标）
-                    int targetCount = (lastKnownMode == 0x01) ? 1 : 3;
-                    for (int i=0; i<targetCount; i++) {
-                        int base = 4 + i*8;
-                        uint16_t rawX = radarBuf[base] | (radarBuf[base+1]<<8);
-                        uint16_t rawY = radarBuf[base+2] | (radarBuf[base+3]<<8);
-                        int16_t x = (rawX & 0x8000) ? (int16_t)(rawX - 0x8000) : -(int16_t)(rawX & 0x7FFF);
-                        int16_t y = (int16_t)(rawY - 0x8000);
-                        if (x != 0 || y != 0) {
-                            char tmp[32];
-                            sprintf(tmp, "[T%d %d,%d] ", i+1, x, y);
-                            output += String(tmp);
-                            hasTarget = true;
-                        }
-                    }
-                    if (hasTarget) Serial.println(output);
-                    else Serial.print(".");
-                    lastDataPrintTime = millis();
-                } else { 
-                    if (millis() % 500 < 20 && millis() % 100 == 0) Serial.print("[❤️ ]\n"); 
-                }
-            }
-            radarBufIdx = 0;
-        }
-    }
-}
\ No newline at end of file
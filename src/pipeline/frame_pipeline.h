@@ -0,0 +1,57 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include <Arduino.h>
+#include "stage_pipeline.h"
+#include "../radar/radar_sensor.h"
+#include "../radar/sensor_fusion.h"
+
+// ================= 帧处理流水线 =================
+// 各处理阶段(过滤 -> 分析 -> 编码 -> 输出)在编译期通过模板参数组合(见 stage_pipeline.h)：
+//   typedef FramePipeline<RangeFilterStage, ConsoleViewStage, TrajectoryStage, ...> MainPipeline;
+// 阶段的 onFrame 接收 FrameContext，onPass 接收 PassContext。
+// 源(数据帧)是 RadarSensor::poll()，由主循环驱动。
+
+// 单帧上下文
+struct FrameContext {
+    RadarSensor& sensor;
+    uint32_t now;
+};
+
+// 一轮轮询的上下文
+struct PassContext {
+    RadarSensor* const* sensors;
+    int sensorCount;
+    int frames;                               // 本轮处理的帧数
+    uint32_t now;
+    FusedTarget fused[FUSION_MAX_TARGETS];    // 由 FusionStage 填充
+    int fusedCount;
+};
+
+template <class... Stages>
+class FramePipeline : public StagePipeline<Stages...> {
+    typedef StagePipeline<Stages...> Base;
+
+public:
+    // 输出各阶段计时
+    void printTiming() {
+#ifdef PIPELINE_TIMING
+        uint32_t mhz = ESP.getCpuFreqMHz();
+        Serial.println("  stage           calls      avg(us)   max(us)");
+        for (size_t i = 0; i < Base::STAGE_COUNT; i++) {
+            if (Base::NAMES[i] == nullptr) continue;
+            const StageTiming& t = this->timings[i];
+            float avg = t.calls ? (float)t.totalCycles / t.calls / mhz : 0;
+            Serial.printf("  %-14s %8lu %10.2f %9.2f\n", Base::NAMES[i], (unsigned long)t.calls, avg, (float)t.maxCycles / mhz);
+        }
+#else
+        Serial.print("  stages:");
+        for (size_t i = 0; i < Base::STAGE_COUNT; i++) {
+            if (Base::NAMES[i] != nullptr) Serial.printf(" %s", Base::NAMES[i]);
+        }
+        Serial.println("\n  (per-stage timing disabled, build with -DPIPELINE_TIMING)");
+#endif
+    }
+};
+
+#endif // FRAME_PIPELINE_H
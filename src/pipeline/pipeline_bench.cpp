@@ -0,0 +1,109 @@
+#include "pipeline_stages.h"
+#include "../radar/radar_config.h"
+#include "../stream/binary_stream.h"
+
+// ================= 流水线开销基准 =================
+
+// 编码：帧记录编码到阶段内的缓冲区
+struct BenchEncodeStage : PipelineStage {
+    static constexpr const char* NAME = "bench-encode";
+    uint8_t out[BIN_MAX_ENCODED_LEN];
+    size_t len = 0;
+    uint32_t seq = 0;
+    bool onFrame(FrameContext& ctx) {
+        len = encodeFrameRecord(seq++, ctx.now, ctx.sensor.id, ctx.sensor.targets, RADAR_MAX_TARGETS, out);
+        return true;
+    }
+};
+
+// 输出：对编码结果求和，防止编译器把前面的阶段优化掉
+struct BenchChecksumSink : PipelineStage {
+    static constexpr const char* NAME = "bench-sink";
+    const BenchEncodeStage* encoder = nullptr;
+    uint32_t sum = 0;
+    bool onFrame(FrameContext&) {
+        for (size_t i = 0; i < encoder->len; i++) sum = sum * 31 + encoder->out[i];
+        return true;
+    }
+};
+
+typedef FramePipeline<RangeFilterStage, BenchEncodeStage, BenchChecksumSink> BenchPipeline;
+
+// 合成目标：三个槽位随机出现，部分超出过滤距离
+static uint32_t benchRand;
+static void fillTargets(Target* t) {
+    for (int i = 0; i < RADAR_MAX_TARGETS; i++) {
+        benchRand = benchRand * 1664525u + 1013904223u;
+        uint32_t r = benchRand >> 8;
+        if (r % 4 == 0) {
+            t[i] = Target{0, 0, 0, 0};
+        } else {
+            t[i] = Target{(int16_t)((int)(r % 8000) - 4000), (int16_t)(r % 9000), (int16_t)((int)(r % 64) - 32), 360};
+        }
+    }
+}
+
+static uint32_t runComposed(BenchPipeline& p, RadarSensor& s, uint32_t frames, uint32_t& sum) {
+    benchRand = 1;
+    p.stage<1>().seq = 0;
+    p.stage<2>().sum = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < frames; i++) {
+        fillTargets(s.targets);
+        FrameContext ctx = {s, i};
+        p.processFrame(ctx);
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+    sum = p.stage<2>().sum;
+    return cycles;
+}
+
+// 手写融合循环：与 BenchPipeline 完全相同的操作
+static uint32_t runFused(RadarSensor& s, uint32_t frames, uint32_t maxRangeMm, uint32_t& sum) {
+    benchRand = 1;
+    uint8_t out[BIN_MAX_ENCODED_LEN];
+    uint32_t limit = maxRangeMm * maxRangeMm;
+    sum = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < frames; i++) {
+        fillTargets(s.targets);
+        for (int k = 0; k < RADAR_MAX_TARGETS; k++) {
+            Target& t = s.targets[k];
+            if (isEmptyTarget(t)) continue;
+            uint32_t d2 = (uint32_t)((int32_t)t.x * t.x) + (uint32_t)((int32_t)t.y * t.y);
+            if (d2 > limit) t = Target{0, 0, 0, 0};
+        }
+        size_t len = encodeFrameRecord(i, i, s.id, s.targets, RADAR_MAX_TARGETS, out);
+        for (size_t k = 0; k < len; k++) sum = sum * 31 + out[k];
+    }
+    return ESP.getCycleCount() - start;
+}
+
+void runPipelineBench(uint32_t frames) {
+    // 独立的传感器实例只作为目标缓冲区，不打开串口
+    RadarSensor sensor(0, RADAR_SENSOR_CONFIGS[0]);
+    static BenchPipeline pipeline;   // 编码缓冲区较大，不放在栈上
+    pipeline.stage<0>().maxRangeMm = 6000;
+    pipeline.stage<2>().encoder = &pipeline.stage<1>();
+    pipeline.resetTiming();
+
+    Serial.printf("\n--- Pipeline Bench: %lu frames (filter -> encode -> checksum) ---\n", (unsigned long)frames);
+    // 交替运行 5 轮，各取最快一轮，减少中断/缓存抖动的影响
+    uint32_t bestComposed = UINT32_MAX, bestFused = UINT32_MAX;
+    uint32_t sumComposed = 0, sumFused = 0;
+    for (int round = 0; round < 5; round++) {
+        bestFused = min(bestFused, runFused(sensor, frames, 6000, sumFused));
+        bestComposed = min(bestComposed, runComposed(pipeline, sensor, frames, sumComposed));
+        delay(1);
+    }
+
+    float mhz = ESP.getCpuFreqMHz();
+    float nsFused = bestFused * 1000.0f / mhz / frames;
+    float nsComposed = bestComposed * 1000.0f / mhz / frames;
+    Serial.printf("  hand-fused : %8.1f ns/frame\n", nsFused);
+    Serial.printf("  composed   : %8.1f ns/frame (%+.1f%%)\n", nsComposed, (nsComposed - nsFused) * 100.0f / nsFused);
+    Serial.printf("  checksum   : %08lX / %08lX %s\n", (unsigned long)sumFused, (unsigned long)sumComposed,
+                  sumFused == sumComposed ? "(match)" : "(MISMATCH)");
+    pipeline.printTiming();
+    Serial.println("--- Done ---\n");
+}
@@ -0,0 +1,86 @@
+#ifndef PIPELINE_STAGES_H
+#define PIPELINE_STAGES_H
+
+#include "frame_pipeline.h"
+#include "../analytics/heatmap.h"
+#include "../analytics/trajectory.h"
+#include "../capture/raw_capture.h"
+
+// ================= 通用流水线阶段 =================
+// 构建开关(platformio.ini 的 build_flags 中定义，缺省值如下)：
+//   PIPELINE_RANGE_FILTER_MM   >0 时启用距离过滤，丢弃距传感器超过该值(mm)的目标
+//   PIPELINE_ENABLE_TRAJECTORY 轨迹压缩(analytics/trajectory)
+//   PIPELINE_ENABLE_HEATMAP    融合 + 占用热力图(analytics/heatmap)
+// 与主循环状态相关的阶段(控制台显示、数据上传)定义在 main.cpp 中。
+
+#ifndef PIPELINE_RANGE_FILTER_MM
+#define PIPELINE_RANGE_FILTER_MM    0
+#endif
+#ifndef PIPELINE_ENABLE_TRAJECTORY
+#define PIPELINE_ENABLE_TRAJECTORY  1
+#endif
+#ifndef PIPELINE_ENABLE_HEATMAP
+#define PIPELINE_ENABLE_HEATMAP     1
+#endif
+
+// 过滤：超出距离的目标清零(之后按空目标处理)，帧本身保留
+struct RangeFilterStage : PipelineStage {
+    static constexpr const char* NAME = "range-filter";
+    uint32_t maxRangeMm = PIPELINE_RANGE_FILTER_MM;
+    uint32_t removed = 0;
+
+    bool onFrame(FrameContext& ctx) {
+        uint32_t limit = maxRangeMm * maxRangeMm;
+        for (int i = 0; i < RADAR_MAX_TARGETS; i++) {
+            Target& t = ctx.sensor.targets[i];
+            if (isEmptyTarget(t)) continue;
+            // x² + y² 最大 2 × 32768²，uint32 不会溢出
+            uint32_t d2 = (uint32_t)((int32_t)t.x * t.x) + (uint32_t)((int32_t)t.y * t.y);
+            if (d2 > limit) {
+                t = Target{0, 0, 0, 0};
+                removed++;
+            }
+        }
+        return true;
+    }
+};
+
+// 分析：按目标槽位更新轨迹压缩
+struct TrajectoryStage : PipelineStage {
+    static constexpr const char* NAME = "trajectory";
+    bool onFrame(FrameContext& ctx) {
+        trajectoryAddFrame(ctx.sensor, ctx.now);
+        return true;
+    }
+};
+
+// 分析：本轮有新帧时融合各传感器目标到房间坐标
+struct FusionStage : PipelineStage {
+    static constexpr const char* NAME = "fusion";
+    void onPass(PassContext& ctx) {
+        if (ctx.frames > 0) ctx.fusedCount = fuseTargets(ctx.sensors, ctx.sensorCount, ctx.fused, ctx.now);
+    }
+};
+
+// 分析 + 输出：融合结果累加到热力图，并按间隔上传快照
+struct HeatmapStage : PipelineStage {
+    static constexpr const char* NAME = "heatmap";
+    void onPass(PassContext& ctx) {
+        if (ctx.frames > 0) heatmapAddFrame(ctx.fused, ctx.fusedCount, ctx.now);
+        heatmapUploadIfDue();
+    }
+};
+
+// 输出：抓包进行中按刷新间隔把未写满的块交给写入任务，推进停止收尾与分段下载(原始字节在 RadarSensor::poll() 中记录)
+struct CaptureStage : PipelineStage {
+    static constexpr const char* NAME = "capture";
+    void onPass(PassContext& ctx) {
+        captureService(ctx.now);
+    }
+};
+
+// 流水线开销基准：同样的 过滤 -> 编码 -> 校验和 分别用组合流水线与手写融合循环执行，
+// 报告每帧耗时与差值
+void runPipelineBench(uint32_t frames);
+
+#endif // PIPELINE_STAGES_H
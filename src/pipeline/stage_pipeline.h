@@ -0,0 +1,124 @@
+#ifndef STAGE_PIPELINE_H
+#define STAGE_PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+#ifdef PIPELINE_TIMING
+#include <Arduino.h>   // ESP.getCycleCount()
+#endif
+
+// ================= 编译期阶段组合 =================
+// 各处理阶段在编译期通过模板参数组合，保存在 std::tuple 中(无堆分配)，按模板参数顺序直接调用，
+// 没有虚函数，编译后可完全内联。上下文类型由使用者决定(雷达帧流水线见 frame_pipeline.h)。
+//
+// 阶段约定(从 PipelineStage 派生，以同名函数覆盖默认实现)：
+//   static constexpr const char* NAME   阶段名，用于计时输出
+//   bool onFrame(FrameCtx& ctx)          每个完整数据帧调用；返回 false 丢弃该帧，后续阶段不再处理
+//   void onPass(PassCtx& ctx)            每次主循环轮询完所有传感器后调用一次(本轮可能没有新帧)
+//
+// 定义 PIPELINE_TIMING 时按阶段统计调用次数与 CPU 周期(平均/最大)，未定义时计时代码不参与编译，
+// 本文件不依赖 Arduino，组合行为由 test/test_stage_pipeline 在主机上检查。
+
+// 阶段基类(非虚)：默认什么都不做
+struct PipelineStage {
+    static constexpr const char* NAME = "stage";
+    template <class Ctx> bool onFrame(Ctx&) { return true; }
+    template <class Ctx> void onPass(Ctx&) {}
+};
+
+// 被构建开关关闭的阶段，调用全部内联为空
+struct NoStage : PipelineStage {
+    static constexpr const char* NAME = nullptr;
+};
+
+// Enabled 为 false 时替换为 NoStage
+template <bool Enabled, class S>
+using StageIf = typename std::conditional<Enabled, S, NoStage>::type;
+
+// 阶段计时
+struct StageTiming {
+    uint32_t calls;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+};
+
+template <class... Stages>
+class StagePipeline {
+public:
+    static constexpr size_t STAGE_COUNT = sizeof...(Stages);
+
+    // 处理一帧：依次调用各阶段 onFrame，返回该帧是否走完全部阶段
+    template <class FrameCtx>
+    inline bool processFrame(FrameCtx& ctx) { return frameFrom<0>(ctx); }
+
+    // 一轮轮询结束：依次调用各阶段 onPass
+    template <class PassCtx>
+    inline void endPass(PassCtx& ctx) { passFrom<0>(ctx); }
+
+    // 取得某个阶段实例(用于运行时参数)
+    template <size_t I>
+    typename std::tuple_element<I, std::tuple<Stages...>>::type& stage() { return std::get<I>(stages); }
+
+    // 阶段名，关闭的阶段为 nullptr
+    static const char* stageName(size_t i) { return i < STAGE_COUNT ? NAMES[i] : nullptr; }
+
+    void resetTiming() {
+#ifdef PIPELINE_TIMING
+        memset(timings, 0, sizeof(timings));
+#endif
+    }
+
+protected:
+    static constexpr const char* NAMES[STAGE_COUNT + 1] = {Stages::NAME..., nullptr};
+    std::tuple<Stages...> stages;
+#ifdef PIPELINE_TIMING
+    StageTiming timings[STAGE_COUNT + 1];
+#endif
+
+private:
+    // 计时钩子：关闭的阶段与未定义 PIPELINE_TIMING 时直接调用
+    template <size_t I, class F>
+    inline auto timed(F&& f) -> decltype(f()) {
+#ifdef PIPELINE_TIMING
+        typedef typename std::tuple_element<I, std::tuple<Stages...>>::type S;
+        if constexpr (!std::is_same<S, NoStage>::value) {
+            uint32_t start = ESP.getCycleCount();
+            struct Record {
+                StageTiming& t;
+                uint32_t start;
+                ~Record() {
+                    uint32_t c = ESP.getCycleCount() - start;
+                    t.calls++;
+                    t.totalCycles += c;
+                    if (c > t.maxCycles) t.maxCycles = c;
+                }
+            } record{timings[I], start};
+            return f();
+        }
+#endif
+        return f();
+    }
+
+    template <size_t I, class FrameCtx>
+    inline bool frameFrom(FrameCtx& ctx) {
+        if constexpr (I == STAGE_COUNT) {
+            return true;
+        } else {
+            if (!timed<I>([&] { return std::get<I>(stages).onFrame(ctx); })) return false;
+            return frameFrom<I + 1>(ctx);
+        }
+    }
+
+    template <size_t I, class PassCtx>
+    inline void passFrom(PassCtx& ctx) {
+        if constexpr (I < STAGE_COUNT) {
+            timed<I>([&] { std::get<I>(stages).onPass(ctx); });
+            passFrom<I + 1>(ctx);
+        }
+    }
+};
+
+#endif // STAGE_PIPELINE_H
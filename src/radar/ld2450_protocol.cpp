@@ -0,0 +1,65 @@
+#include "ld2450_protocol.h"
+#include <Arduino.h>
+#include "../log/log_ring.h"
+
+namespace ld2450 {
+
+// ================= ACK 输出 =================
+
+void Empty::print() const {
+    LOG_I(LOG_MOD_CMD, "SUCCESS\n");
+}
+
+void Word::print() const {
+    LOG_I(LOG_MOD_CMD, "SUCCESS -> 0x%04X\n", value);
+}
+
+void ConfigAck::print() const {
+    LOG_I(LOG_MOD_CMD, "ENABLED (protocol 0x%04X, buffer %d)\n", protocolVersion, bufferSize);
+}
+
+void TrackingMode::print() const {
+    LOG_I(LOG_MOD_CMD, "SUCCESS -> Mode: %s\n", (mode == MODE_MULTI) ? "Multi Target" : "Single Target");
+}
+
+void FirmwareVersion::print() const {
+    LOG_I(LOG_MOD_CMD, "SUCCESS -> Firmware: V%x.%02x.%08X\n", (major >> 8), (major & 0xFF), minor);
+}
+
+void MacAddress::print() const {
+    LOG_I(LOG_MOD_CMD, "SUCCESS -> MAC: %02X:%02X:%02X:%02X:%02X:%02X\n",
+          mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+void ZoneConfig::print() const {
+    LOG_I(LOG_MOD_CMD, "SUCCESS -> Zone: Type=%d (0:Off, 1:Det, 2:Filt)\n", type);
+    for (int i = 0; i < LD2450_ZONE_COUNT; i++) {
+        LOG_I(LOG_MOD_CMD, "           Z%d: (%d,%d)-(%d,%d)\n", i + 1,
+              zones[i].x1, zones[i].y1, zones[i].x2, zones[i].y2);
+    }
+}
+
+template <> void printAck<EnableConfig>(const uint8_t*) {
+    LOG_I(LOG_MOD_CMD, "ENABLED\n");
+}
+
+template <> void printAck<EndConfig>(const uint8_t*) {
+    LOG_I(LOG_MOD_CMD, "ENDED\n");
+}
+
+template <> void printAck<SetBluetooth>(const uint8_t*) {
+    LOG_I(LOG_MOD_CMD, "SUCCESS -> Bluetooth config saved.\n");
+}
+
+void printCommandTable() {
+    Serial.println("\n--- LD2450 Command Table ---");
+    Serial.println("  opcode  req  ack  reboot  name");
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        const CommandDesc& d = COMMAND_TABLE[i];
+        Serial.printf("  0x%04X  %3u  %3u  %-6s  %s\n", d.opcode, d.requestLen, d.ackLen,
+                      d.needsReboot ? "yes" : "no", d.name);
+    }
+    Serial.printf("  max ACK frame %u B, max request frame %u B\n", MAX_ACK_FRAME, MAX_REQUEST_FRAME);
+}
+
+} // namespace ld2450
@@ -0,0 +1,318 @@
+#ifndef LD2450_PROTOCOL_H
+#define LD2450_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ================= LD2450 串口协议描述表 =================
+// 依据《LD2450 串口通信协议 V1.03》。每条指令由一个 Command 类型描述：命令字、
+// 命令值布局、ACK 数据布局(状态字之后的部分)以及是否需重启生效；COMMAND_TABLE 由这些
+// 类型在编译期生成。已知指令使用 encodeRequest<C>/decodeAck<C>，命令字、长度与表项
+// 均为编译期常量，运行时不查表。
+// 编码/解码往返与异常帧检查见 test/test_ld2450_protocol(pio test -e native)。
+//
+// 指令帧: FD FC FB FA | 长度(2) | 命令字(2) | 命令值 | 04 03 02 01
+// ACK 帧: FD FC FB FA | 长度(2) | 命令字|0x0100(2) | 状态(2, 0=成功) | ACK 数据 | 04 03 02 01
+// 长度 = 命令字 + 命令值(或 回显命令字 + 状态 + ACK 数据)；多字节字段均为小端。
+
+namespace ld2450 {
+
+inline constexpr uint8_t FRAME_HEAD[] = {0xFD, 0xFC, 0xFB, 0xFA};
+inline constexpr uint8_t FRAME_TAIL[] = {0x04, 0x03, 0x02, 0x01};
+constexpr uint16_t FRAME_OVERHEAD = 4 + 2 + 4;   // 帧头 + 长度 + 帧尾
+constexpr uint16_t ACK_FLAG = 0x0100;            // ACK 回显命令字 = 命令字 | 0x0100
+
+inline void putU16(uint8_t* p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+inline uint16_t getU16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+inline uint32_t getU32(const uint8_t* p) { return getU16(p) | ((uint32_t)getU16(p + 2) << 16); }
+
+// ================= 数据布局 =================
+// 每种布局给出 SIZE、encode/decode 与日志输出；decode 对取值做范围校验
+
+// 无数据
+struct Empty {
+    static constexpr uint16_t SIZE = 0;
+    void encode(uint8_t*) const {}
+    bool decode(const uint8_t*) { return true; }
+    void print() const;
+};
+
+// 单个 16 位值(波特率索引、蓝牙开关)
+struct Word {
+    uint16_t value;
+    static constexpr uint16_t SIZE = 2;
+    void encode(uint8_t* p) const { putU16(p, value); }
+    bool decode(const uint8_t* p) { value = getU16(p); return true; }
+    void print() const;
+};
+
+// 固定的 16 位命令值(使能配置、MAC 查询均为 0x0001)，只用作请求布局
+template <uint16_t V>
+struct Fixed {
+    static constexpr uint16_t SIZE = 2;
+    void encode(uint8_t* p) const { putU16(p, V); }
+    bool decode(const uint8_t* p) const { return getU16(p) == V; }
+};
+
+// 使能配置 ACK
+struct ConfigAck {
+    uint16_t protocolVersion;
+    uint16_t bufferSize;
+    static constexpr uint16_t SIZE = 4;
+    void encode(uint8_t* p) const { putU16(p, protocolVersion); putU16(p + 2, bufferSize); }
+    bool decode(const uint8_t* p) { protocolVersion = getU16(p); bufferSize = getU16(p + 2); return true; }
+    void print() const;
+};
+
+// 追踪模式
+enum TrackingModeValue : uint16_t {
+    MODE_SINGLE = 0x0001,
+    MODE_MULTI  = 0x0002
+};
+
+struct TrackingMode {
+    uint16_t mode;
+    static constexpr uint16_t SIZE = 2;
+    void encode(uint8_t* p) const { putU16(p, mode); }
+    bool decode(const uint8_t* p) { mode = getU16(p); return mode == MODE_SINGLE || mode == MODE_MULTI; }
+    void print() const;
+};
+
+// 固件版本：类型(2) + 主版本(2) + 次版本(4)
+struct FirmwareVersion {
+    uint16_t type;
+    uint16_t major;
+    uint32_t minor;
+    static constexpr uint16_t SIZE = 8;
+    void encode(uint8_t* p) const { putU16(p, type); putU16(p + 2, major); putU16(p + 4, minor & 0xFFFF); putU16(p + 6, minor >> 16); }
+    bool decode(const uint8_t* p) { type = getU16(p); major = getU16(p + 2); minor = getU32(p + 4); return true; }
+    void print() const;
+};
+
+struct MacAddress {
+    uint8_t mac[6];
+    static constexpr uint16_t SIZE = 6;
+    void encode(uint8_t* p) const { for (int i = 0; i < 6; i++) p[i] = mac[i]; }
+    bool decode(const uint8_t* p) { for (int i = 0; i < 6; i++) mac[i] = p[i]; return true; }
+    void print() const;
+};
+
+// 区域过滤：类型(2) + 3 个矩形区域(对角坐标，有符号 mm)
+enum ZoneType : uint16_t {
+    ZONE_OFF    = 0,   // 关闭区域过滤
+    ZONE_DETECT = 1,   // 仅检测区域内的目标
+    ZONE_FILTER = 2    // 不检测区域内的目标
+};
+
+#define LD2450_ZONE_COUNT 3
+
+struct ZoneRect {
+    int16_t x1, y1, x2, y2;
+};
+
+struct ZoneConfig {
+    uint16_t type;
+    ZoneRect zones[LD2450_ZONE_COUNT];
+    static constexpr uint16_t SIZE = 2 + LD2450_ZONE_COUNT * 8;
+    void encode(uint8_t* p) const {
+        putU16(p, type);
+        for (int i = 0; i < LD2450_ZONE_COUNT; i++) {
+            uint8_t* z = p + 2 + i * 8;
+            putU16(z, zones[i].x1); putU16(z + 2, zones[i].y1);
+            putU16(z + 4, zones[i].x2); putU16(z + 6, zones[i].y2);
+        }
+    }
+    bool decode(const uint8_t* p) {
+        type = getU16(p);
+        for (int i = 0; i < LD2450_ZONE_COUNT; i++) {
+            const uint8_t* z = p + 2 + i * 8;
+            zones[i].x1 = (int16_t)getU16(z); zones[i].y1 = (int16_t)getU16(z + 2);
+            zones[i].x2 = (int16_t)getU16(z + 4); zones[i].y2 = (int16_t)getU16(z + 6);
+        }
+        return type <= ZONE_FILTER;
+    }
+    void print() const;
+};
+
+// 波特率索引(0x00A1 命令值)
+enum BaudIndex : uint16_t {
+    BAUD_9600 = 0x0001, BAUD_19200, BAUD_38400, BAUD_57600,
+    BAUD_115200, BAUD_230400, BAUD_256000, BAUD_460800
+};
+
+// ================= 指令 =================
+
+template <uint16_t Op, class Req, class Ack, bool Reboot>
+struct Command {
+    static constexpr uint16_t OPCODE = Op;
+    static constexpr bool NEEDS_REBOOT = Reboot;    // 需重启雷达才生效
+    typedef Req Request;
+    typedef Ack Response;
+};
+
+typedef Command<0x00FF, Fixed<1>,   ConfigAck,       false> EnableConfig;
+typedef Command<0x00FE, Empty,      Empty,           false> EndConfig;
+typedef Command<0x0080, Empty,      Empty,           false> SetSingleTarget;
+typedef Command<0x0090, Empty,      Empty,           false> SetMultiTarget;
+typedef Command<0x0091, Empty,      TrackingMode,    false> QueryMode;
+typedef Command<0x00A0, Empty,      FirmwareVersion, false> QueryVersion;
+typedef Command<0x00A1, Word,       Empty,           true>  SetBaudRate;    // BaudIndex
+typedef Command<0x00A2, Empty,      Empty,           true>  FactoryReset;
+typedef Command<0x00A3, Empty,      Empty,           false> Reboot;         // ACK 后立即重启
+typedef Command<0x00A4, Word,       Empty,           true>  SetBluetooth;   // 0x0001 开 / 0x0000 关
+typedef Command<0x00A5, Fixed<1>,   MacAddress,      false> QueryMac;
+typedef Command<0x00C1, Empty,      ZoneConfig,      false> QueryZone;
+typedef Command<0x00C2, ZoneConfig, Empty,           false> SetZone;
+
+// ================= 描述表 =================
+
+// ACK 数据输出(非静默时调用)；默认按 ACK 布局输出，个别指令特化
+template <class C>
+void printAck(const uint8_t* data) {
+    typename C::Response r;
+    r.decode(data);
+    r.print();
+}
+template <> void printAck<EnableConfig>(const uint8_t* data);
+template <> void printAck<EndConfig>(const uint8_t* data);
+template <> void printAck<SetBluetooth>(const uint8_t* data);
+
+struct CommandDesc {
+    uint16_t opcode;
+    uint16_t requestLen;      // 命令值长度
+    uint16_t ackLen;          // ACK 数据长度(不含回显命令字与状态字)
+    bool needsReboot;
+    const char* name;
+    void (*printAck)(const uint8_t* data);
+};
+
+template <class C>
+constexpr CommandDesc describe(const char* name) {
+    return CommandDesc{C::OPCODE, C::Request::SIZE, C::Response::SIZE, C::NEEDS_REBOOT, name, &printAck<C>};
+}
+
+inline constexpr CommandDesc COMMAND_TABLE[] = {
+    describe<EnableConfig>("Enable Config"),
+    describe<EndConfig>("End Config"),
+    describe<SetSingleTarget>("Set Single Target"),
+    describe<SetMultiTarget>("Set Multi Target"),
+    describe<QueryMode>("Query Mode"),
+    describe<QueryVersion>("Query Version"),
+    describe<SetBaudRate>("Set Baud Rate"),
+    describe<FactoryReset>("Factory Reset"),
+    describe<Reboot>("Reboot Module"),
+    describe<SetBluetooth>("Set Bluetooth"),
+    describe<QueryMac>("Query MAC"),
+    describe<QueryZone>("Query Zone"),
+    describe<SetZone>("Set Zone"),
+};
+constexpr size_t COMMAND_COUNT = sizeof(COMMAND_TABLE) / sizeof(COMMAND_TABLE[0]);
+
+constexpr size_t indexOf(uint16_t opcode) {
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        if (COMMAND_TABLE[i].opcode == opcode) return i;
+    }
+    return COMMAND_COUNT;
+}
+
+constexpr bool opcodesUnique() {
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        if (indexOf(COMMAND_TABLE[i].opcode) != i) return false;
+    }
+    return true;
+}
+static_assert(opcodesUnique(), "LD2450 command table has duplicate opcodes");
+
+constexpr uint16_t maxAckLen() {
+    uint16_t m = 0;
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        if (COMMAND_TABLE[i].ackLen > m) m = COMMAND_TABLE[i].ackLen;
+    }
+    return m;
+}
+
+constexpr uint16_t maxRequestLen() {
+    uint16_t m = 0;
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        if (COMMAND_TABLE[i].requestLen > m) m = COMMAND_TABLE[i].requestLen;
+    }
+    return m;
+}
+
+// 最长 ACK 帧：帧头 + 长度 + 回显命令字 + 状态 + ACK 数据 + 帧尾
+constexpr uint16_t MAX_ACK_FRAME = FRAME_OVERHEAD + 2 + 2 + maxAckLen();
+constexpr uint16_t MAX_REQUEST_FRAME = FRAME_OVERHEAD + 2 + maxRequestLen();
+
+// 指令 C 的表项(编译期确定)
+template <class C>
+constexpr const CommandDesc& descOf() {
+    static_assert(indexOf(C::OPCODE) < COMMAND_COUNT, "command missing from COMMAND_TABLE");
+    return COMMAND_TABLE[indexOf(C::OPCODE)];
+}
+
+// ================= 编码/解码 =================
+
+template <class C>
+constexpr uint16_t requestFrameLen() { return FRAME_OVERHEAD + 2 + C::Request::SIZE; }
+
+// 编码通用指令帧，返回帧长；out 至少 FRAME_OVERHEAD + 2 + valueLen 字节
+inline uint16_t encodeFrame(uint16_t opcode, const uint8_t* value, uint16_t valueLen, uint8_t* out) {
+    for (int i = 0; i < 4; i++) out[i] = FRAME_HEAD[i];
+    putU16(out + 4, 2 + valueLen);
+    putU16(out + 6, opcode);
+    for (uint16_t i = 0; i < valueLen; i++) out[8 + i] = value[i];
+    for (int i = 0; i < 4; i++) out[8 + valueLen + i] = FRAME_TAIL[i];
+    return FRAME_OVERHEAD + 2 + valueLen;
+}
+
+// 编码指令 C 的命令值
+template <class C>
+void encodeValue(const typename C::Request& req, uint8_t* out) {
+    req.encode(out);
+}
+
+// 编码指令 C 的完整帧，out 至少 requestFrameLen<C>() 字节
+template <class C>
+uint16_t encodeRequest(const typename C::Request& req, uint8_t* out) {
+    uint8_t value[C::Request::SIZE + 1];
+    req.encode(value);
+    return encodeFrame(C::OPCODE, value, C::Request::SIZE, out);
+}
+
+// ACK 帧校验结果
+enum AckResult {
+    ACK_OK = 0,
+    ACK_BAD_FRAME,      // 帧头/帧尾/长度不符
+    ACK_WRONG_CMD,      // 回显命令字不是本指令(残留的旧 ACK)
+    ACK_BAD_LENGTH,     // ACK 数据长度与描述表不符
+    ACK_STATUS_ERROR    // 状态字非 0
+};
+
+// 校验一帧完整 ACK；成功时 data 指向 ACK 数据，status 为状态字
+inline AckResult checkAck(const CommandDesc& desc, const uint8_t* frame, uint16_t frameLen,
+                          const uint8_t** data, uint16_t* status) {
+    if (frameLen < FRAME_OVERHEAD + 4) return ACK_BAD_FRAME;
+    for (int i = 0; i < 4; i++) {
+        if (frame[i] != FRAME_HEAD[i] || frame[frameLen - 4 + i] != FRAME_TAIL[i]) return ACK_BAD_FRAME;
+    }
+    if (getU16(frame + 4) != frameLen - FRAME_OVERHEAD) return ACK_BAD_FRAME;
+    if (getU16(frame + 6) != (desc.opcode | ACK_FLAG)) return ACK_WRONG_CMD;
+    *status = getU16(frame + 8);
+    if (*status != 0) return ACK_STATUS_ERROR;
+    if (frameLen - FRAME_OVERHEAD - 4 != desc.ackLen) return ACK_BAD_LENGTH;
+    *data = frame + 10;
+    return ACK_OK;
+}
+
+// 解码指令 C 的 ACK 数据
+template <class C>
+bool decodeAck(const uint8_t* data, typename C::Response& out) {
+    return out.decode(data);
+}
+
+// 输出描述表
+void printCommandTable();
+
+} // namespace ld2450
+
+#endif // LD2450_PROTOCOL_H
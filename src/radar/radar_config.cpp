@@ -0,0 +1,19 @@
+#include "radar_config.h"
+
+// ================= 全局变量定义 =================
+// 请按实际接线修改；默认仅 Serial1 上的一个雷达，安装在房间原点，无旋转
+const RadarSensorConfig RADAR_SENSOR_CONFIGS[] = {
+    { &Serial1, 16, 17, { 0, 0, 0 } },     // S0 🔧 RX=GPIO16 TX=GPIO17
+    // { &Serial2, 18, 8, { 0, 6000, 180 } },  // S1 🔧 示例：对面墙上的第二个雷达
+};
+const int RADAR_SENSOR_COUNT = sizeof(RADAR_SENSOR_CONFIGS) / sizeof(RADAR_SENSOR_CONFIGS[0]);
+
+RadarSensor* radarSensors[RADAR_MAX_SENSORS] = {NULL};
+int radarSensorCount = 0;
+
+void initRadarSensors() {
+    for (int i = 0; i < RADAR_SENSOR_COUNT && radarSensorCount < RADAR_MAX_SENSORS; i++) {
+        radarSensors[radarSensorCount] = new RadarSensor(radarSensorCount, RADAR_SENSOR_CONFIGS[i]);
+        radarSensorCount++;
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef RADAR_CONFIG_H
+#define RADAR_CONFIG_H
+
+#include <Arduino.h>
+#include "radar_sensor.h"
+
+// ================= 雷达传感器配置 =================
+// 🔧 如何增加传感器：
+// 1. 打开 src/radar/radar_config.cpp 文件
+// 2. 在 RADAR_SENSOR_CONFIGS 中为每个 LD2450 添加一行：串口、RX、TX、安装位置与朝向
+// 3. 保存文件并重新编译上传
+//
+// ESP32-S3 共有 3 个 UART：UART0 为控制台，Serial1/Serial2 可各接一个雷达；
+// 若控制台改用原生 USB CDC(ARDUINO_USB_CDC_ON_BOOT=1)，Serial0 也可接第三个雷达。
+//
+// 安装位置使用房间坐标(mm)：offsetX/offsetY 为传感器所在位置，rotationDeg 为逆时针旋转角度。
+// 例如房间两侧对射：
+// { &Serial1, 16, 17, {    0,    0,   0 } },
+// { &Serial2, 18,  8, {    0, 6000, 180 } },
+extern const RadarSensorConfig RADAR_SENSOR_CONFIGS[];
+extern const int RADAR_SENSOR_COUNT;
+
+// ================= 全局变量 =================
+extern RadarSensor* radarSensors[RADAR_MAX_SENSORS];   // 传感器实例
+extern int radarSensorCount;                           // 实例数量
+
+// 按配置表创建传感器实例(setup 中调用一次)
+void initRadarSensors();
+
+#endif // RADAR_CONFIG_H
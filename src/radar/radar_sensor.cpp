@@ -0,0 +1,505 @@
+#include "radar_sensor.h"
+#include "../log/log_ring.h"
+#include "../sys/loop_events.h"
+#include "../capture/raw_capture.h"
+
+// 数据帧头尾
+static const uint8_t HEAD[] = {0xAA, 0xFF, 0x03, 0x00};
+static const uint8_t TAIL[] = {0x55, 0xCC};
+
+RadarSensor::RadarSensor(uint8_t id, const RadarSensorConfig& cfg)
+    : id(id), currentBaudRate(256000), isBaudLocked(false), lastKnownMode(-1),
+      serial(*cfg.port), rxPin(cfg.rxPin), txPin(cfg.txPin),
+      bufIdx(0), rxLen(0), rxPos(0), rateFrames(0), rateDrops(0), rateStart(0),
+      rxEventUs(0), rxEventCount(0), rxOverflowCount(0), eventsAtLastFrame(0) {
+    memset(targets, 0, sizeof(targets));
+    memset(&metrics, 0, sizeof(metrics));
+    setMount(cfg.mount);
+}
+
+void RadarSensor::setMount(const MountTransform& m) {
+    mount = m;
+    float rad = m.rotationDeg * (float)DEG_TO_RAD;
+    cosR = cosf(rad);
+    sinR = sinf(rad);
+}
+
+// 结果限幅到 int16_t：安装偏移较大时旋转后再平移可能超出范围
+void RadarSensor::toRoom(const Target& t, int16_t& x, int16_t& y) const {
+    int32_t rx = lroundf(cosR * t.x - sinR * t.y) + mount.offsetX;
+    int32_t ry = lroundf(sinR * t.x + cosR * t.y) + mount.offsetY;
+    x = (int16_t)constrain(rx, (int32_t)INT16_MIN, (int32_t)INT16_MAX);
+    y = (int16_t)constrain(ry, (int32_t)INT16_MIN, (int32_t)INT16_MAX);
+}
+
+// ================= 串口 =================
+
+void RadarSensor::begin(long baud) {
+    serial.setRxBufferSize(RADAR_RX_BUFFER);
+    serial.begin(baud, SERIAL_8N1, rxPin, txPin);
+    // 帧突发结束(接收超时)时回调，唤醒主循环整帧处理；轮询模式下仅用于测量延迟
+    serial.setRxTimeout(RADAR_RX_TIMEOUT_SYMBOLS);
+    serial.onReceive([this]() { onUartEvent(); });
+    attachErrorHandler();
+    if (rateStart == 0) rateStart = millis();
+}
+
+void RadarSensor::attachErrorHandler() {
+    serial.onReceiveError([this](hardwareSerial_error_t err) { onUartError(err); });
+}
+
+// UART 事件任务中执行，只记录时间并唤醒主循环
+void RadarSensor::onUartEvent() {
+    rxEventUs = micros();
+    rxEventCount = rxEventCount + 1;
+    wakeMainLoop();
+}
+
+// UART 事件任务中执行：接收缓冲或硬件 FIFO 满说明摄入跟不上，之后的字节已被丢弃
+void RadarSensor::onUartError(hardwareSerial_error_t err) {
+    if (err == UART_BUFFER_FULL_ERROR || err == UART_FIFO_OVF_ERROR) {
+        rxOverflowCount = rxOverflowCount + 1;
+    }
+}
+
+void RadarSensor::end() {
+    serial.end();
+    resetParser();
+}
+
+void RadarSensor::clearBuffer() {
+    unsigned long start = millis();
+    int cleared = 0;
+    // 持续读取直到缓冲区为空，或者超过100ms（防止死循环）
+    while ((serial.available() > 0) && (millis() - start < 100)) {
+        serial.read();
+        cleared++;
+    }
+    rxLen = rxPos = 0;
+    // 如果清理了数据，打印调试信息
+    if (cleared > 0) {
+        LOG_D(LOG_MOD_RADAR, "[DEBUG] [S%d] Cleared %d bytes from serial buffer\n", id, cleared);
+    }
+}
+
+void RadarSensor::resetParser() {
+    bufIdx = 0;
+    rxLen = rxPos = 0;
+}
+
+bool RadarSensor::hasPendingData() {
+    return rxPos < rxLen || serial.available() > 0;
+}
+
+bool RadarSensor::waitRx(unsigned long start, unsigned long timeoutMs) {
+    while (serial.available() <= 0) {
+        unsigned long elapsed = millis() - start;
+        if (elapsed >= timeoutMs) return false;
+        waitLoopEvent(timeoutMs - elapsed);
+    }
+    return true;
+}
+
+// ================= 数据帧解析 =================
+
+bool RadarSensor::poll() {
+    for (;;) {
+        if (rxPos >= rxLen) {
+            int avail = serial.available();
+            if (avail <= 0) return false;
+            rxLen = serial.read(rx, min(avail, (int)sizeof(rx)));
+            rxPos = 0;
+            if (rxLen <= 0) {
+                rxLen = 0;
+                return false;
+            }
+            metrics.bytes += rxLen;
+            captureTap(id, rx, rxLen);
+        }
+        while (rxPos < rxLen) {
+            if (parseByte(rx[rxPos++])) {
+                recordLatency();
+                return true;
+            }
+        }
+    }
+}
+
+// 记录 接收事件 -> 帧交给处理 的延迟；轮询先于事件回调读到数据时不计入
+void RadarSensor::recordLatency() {
+    uint32_t events = rxEventCount;
+    if (events == eventsAtLastFrame) return;
+    eventsAtLastFrame = events;
+    uint32_t latency = micros() - rxEventUs;
+    if (latency > metrics.latencyMaxUs) metrics.latencyMaxUs = latency;
+    metrics.latencyTotalUs += latency;
+    metrics.latencySamples++;
+}
+
+bool RadarSensor::parseByte(uint8_t b) {
+    if (bufIdx < 4) {
+        if (b == HEAD[bufIdx]) buf[bufIdx++] = b;
+        else {
+            if (bufIdx > 0) metrics.resyncs++;
+            if (b == HEAD[0]) { buf[0] = b; bufIdx = 1; }
+            else bufIdx = 0;
+        }
+        return false;
+    }
+
+    buf[bufIdx++] = b;
+    if (bufIdx >= RADAR_BUF_SIZE) {
+        bufIdx = 0;
+        metrics.resyncs++;
+        return false;
+    }
+    if (bufIdx >= RADAR_FRAME_LEN && buf[28] == TAIL[0] && buf[29] == TAIL[1]) {
+        bufIdx = 0;
+        parseTargets();
+
+        unsigned long now = millis();
+        if (metrics.frames > 0 && now - metrics.lastFrameAt > metrics.maxFrameGapMs) {
+            metrics.maxFrameGapMs = now - metrics.lastFrameAt;
+        }
+        metrics.lastFrameAt = now;
+        metrics.frames++;
+        return true;
+    }
+    return false;
+}
+
+// 解析雷达数据并填充targets数组
+void RadarSensor::parseTargets() {
+    for (int i = 0; i < RADAR_MAX_TARGETS; i++) {
+        int base = 4 + i * 8;
+        uint16_t rawX = buf[base] | (buf[base+1]<<8);
+        uint16_t rawY = buf[base+2] | (buf[base+3]<<8);
+        uint16_t rawSpeed = buf[base+4] | (buf[base+5]<<8);
+
+        // X坐标：最高位决定正负
+        targets[i].x = (rawX & 0x8000) ? (int16_t)(rawX - 0x8000) : -(int16_t)(rawX & 0x7FFF);
+        // Y坐标：总是正坐标，减去32768
+        targets[i].y = (int16_t)(rawY - 0x8000);
+        // 速度：最高位决定正负
+        targets[i].speed = (rawSpeed & 0x8000) ? (int16_t)(rawSpeed - 0x8000) : -(int16_t)(rawSpeed & 0x7FFF);
+
+        targets[i].resolution = buf[base+6] | (buf[base+7]<<8);
+    }
+}
+
+bool RadarSensor::waitForFrame(unsigned long timeoutMs) {
+    unsigned long start = millis();
+    while (waitRx(start, timeoutMs)) {
+        if (poll()) return true;
+    }
+    return false;
+}
+
+// ================= 指令 =================
+
+void RadarSensor::sendPacket(uint16_t cmdWord, const uint8_t* value, uint16_t valueLen) {
+    uint16_t dataLen = 2 + valueLen;
+    serial.write(ld2450::FRAME_HEAD, 4);
+    serial.write((uint8_t)(dataLen & 0xFF));
+    serial.write((uint8_t)((dataLen >> 8) & 0xFF));
+    serial.write((uint8_t)(cmdWord & 0xFF));
+    serial.write((uint8_t)((cmdWord >> 8) & 0xFF));
+    if (valueLen > 0 && value != NULL) serial.write(value, valueLen);
+    serial.write(ld2450::FRAME_TAIL, 4);
+}
+
+// 智能 ACK 解析函数 (支持 silent 模式)
+// 按帧头同步、按长度字段收帧，夹在前面的数据帧与回显命令字不符的残留 ACK 被跳过
+bool RadarSensor::waitForAck(const ld2450::CommandDesc& cmd, unsigned long timeoutMs, bool silent, uint8_t* ackData) {
+    unsigned long start = millis();
+    uint8_t ackBuf[ld2450::MAX_ACK_FRAME];
+    uint16_t ackIdx = 0;
+    uint16_t frameLen = 0;
+
+    while (waitRx(start, timeoutMs)) {
+        uint8_t b = serial.read();
+        if (ackIdx < 4) {
+            if (b == ld2450::FRAME_HEAD[ackIdx]) ackBuf[ackIdx++] = b;
+            else ackIdx = (b == ld2450::FRAME_HEAD[0]) ? 1 : 0;
+            continue;
+        }
+        ackBuf[ackIdx++] = b;
+        if (ackIdx == 6) {
+            frameLen = ld2450::FRAME_OVERHEAD + ld2450::getU16(ackBuf + 4);
+            // 长度超出描述表中最长的 ACK：不是本协议的帧，重新同步
+            if (frameLen > sizeof(ackBuf) || frameLen < ld2450::FRAME_OVERHEAD + 4) {
+                metrics.resyncs++;
+                ackIdx = 0;
+            }
+            continue;
+        }
+        if (ackIdx < 6 || ackIdx < frameLen) continue;
+
+        ackIdx = 0;
+        captureTap(id | CAPTURE_SRC_ACK, ackBuf, frameLen);
+        const uint8_t* data = NULL;
+        uint16_t status = 0;
+        ld2450::AckResult result = ld2450::checkAck(cmd, ackBuf, frameLen, &data, &status);
+        if (result == ld2450::ACK_BAD_FRAME || result == ld2450::ACK_WRONG_CMD) {
+            metrics.resyncs++;
+            continue;
+        }
+        if (result != ld2450::ACK_OK) {
+            metrics.ackFailures++;
+            if (!silent) {
+                if (result == ld2450::ACK_STATUS_ERROR) LOG_W(LOG_MOD_CMD, "FAILED (Err: 0x%04X)\n", status);
+                else LOG_W(LOG_MOD_CMD, "FAILED (ACK length %d, expected %d)\n", frameLen - ld2450::FRAME_OVERHEAD - 4, cmd.ackLen);
+            }
+            return false;
+        }
+        metrics.acks++;
+        if (ackData != NULL) memcpy(ackData, data, cmd.ackLen);
+        onAck(cmd, data, silent);
+        return true;
+    }
+    metrics.ackFailures++;
+    if(!silent) LOG_W(LOG_MOD_CMD, "TIMEOUT\n");
+    return false;
+}
+
+// ACK 成功后的输出与状态更新
+void RadarSensor::onAck(const ld2450::CommandDesc& cmd, const uint8_t* data, bool silent) {
+    if (!silent) {
+        cmd.printAck(data);
+        if (cmd.needsReboot) LOG_I(LOG_MOD_CMD, ">> NOTICE: Please execute 'reboot' command to apply changes! <<\n");
+    }
+
+    int mode = -1;
+    if (cmd.opcode == ld2450::QueryMode::OPCODE) {
+        ld2450::TrackingMode m;
+        if (ld2450::decodeAck<ld2450::QueryMode>(data, m)) mode = m.mode;
+        if (silent && mode != -1 && lastKnownMode != -1 && mode != lastKnownMode) {
+            LOG_W(LOG_MOD_CMD, "\n\n-----------------------------------------\n");
+            LOG_W(LOG_MOD_CMD, "[Auto-Check] ALERT: S%d Mode Changed to %s!\n", id, (mode == ld2450::MODE_MULTI) ? "Multi" : "Single");
+            LOG_W(LOG_MOD_CMD, "-----------------------------------------\n\n");
+        }
+    }
+    // 本机切换模式不触发巡检报警
+    else if (cmd.opcode == ld2450::SetSingleTarget::OPCODE) mode = ld2450::MODE_SINGLE;
+    else if (cmd.opcode == ld2450::SetMultiTarget::OPCODE) mode = ld2450::MODE_MULTI;
+    if (mode != -1) lastKnownMode = mode;
+}
+
+void RadarSensor::enableConfig(bool silent) {
+    if (!silent) LOG_I(LOG_MOD_CMD, "[CMD] Enabling Config... ");
+    send<ld2450::EnableConfig>();
+    waitForAck(ld2450::descOf<ld2450::EnableConfig>(), 600, silent);
+}
+
+void RadarSensor::endConfig(bool silent) {
+    if (!silent) LOG_I(LOG_MOD_CMD, "[CMD] Ending Config...   ");
+    send<ld2450::EndConfig>();
+    waitForAck(ld2450::descOf<ld2450::EndConfig>(), 600, silent);
+}
+
+bool RadarSensor::runCmd(const ld2450::CommandDesc& cmd, const char* name, const uint8_t* value, uint16_t valueLen) {
+    // name 可能是临时字符串，直接输出；之后的指令过程走日志缓冲区，结束时统一刷出
+    // 二进制流模式下(远程指令)不输出文本
+    logFlush();
+    if (!logOutputHeld()) Serial.printf("\n--- Executing: %s [S%d] ---\n", name, id);
+    if (valueLen != cmd.requestLen) {
+        if (!logOutputHeld()) Serial.printf(">> %s expects %d value bytes, got %d\n", cmd.name, cmd.requestLen, valueLen);
+        return false;
+    }
+
+    // [Fix] 这里的清理依然保留
+    clearBuffer();
+
+    enableConfig(false);
+    delay(50);
+
+    LOG_I(LOG_MOD_CMD, "[CMD] Sending Packet...  ");
+    sendPacket(cmd.opcode, value, valueLen);
+    bool acked = waitForAck(cmd, 600, false);
+    delay(50);
+
+    endConfig(false);
+    LOG_I(LOG_MOD_CMD, "--- Done ---\n\n");
+    logFlush();
+    // 配置期间的数据帧已被 ACK 解析消耗，半帧作废
+    resetParser();
+    return acked;
+}
+
+// === 后台自动检测 ===
+void RadarSensor::performAutoCheck() {
+    enableConfig(true); // 静默进入
+    delay(20);
+    send<ld2450::QueryMode>();
+    waitForAck(ld2450::descOf<ld2450::QueryMode>(), 300, true);
+    delay(20);
+    endConfig(true); // 静默退出
+    resetParser();
+}
+
+// ================= 波特率 =================
+
+bool RadarSensor::hotStart() {
+    // [优化策略] 热重启优化：先尝试256000默认波特率
+    Serial.printf("[S%d] Trying default 256000 baud rate for hot restart (RX=%d TX=%d)...\n", id, rxPin, txPin);
+    begin(256000);
+    delay(100);
+    clearBuffer();
+
+    // 检查是否能接收到雷达数据
+    if (waitForFrame(2000)) {
+        Serial.printf("[S%d] Radar responding at 256000 baud, sending reboot command...\n", id);
+        // 发送重启命令清理状态
+        send<ld2450::Reboot>();
+        serial.flush();
+        delay(2000); // 等待雷达重启
+
+        // 重启后再次验证连接
+        clearBuffer();
+        resetParser();
+        if (waitForFrame(2000)) {
+            Serial.printf("[S%d] Radar reconnected successfully at 256000 baud!\n", id);
+            currentBaudRate = 256000;
+            isBaudLocked = true;
+            return true;
+        }
+        Serial.printf("[S%d] Radar not responding after reboot, falling back to baud rate scan...\n", id);
+    } else {
+        Serial.printf("[S%d] Radar not responding at 256000 baud, starting baud rate scan...\n", id);
+    }
+    end();
+    scanBaudRate();
+    return isBaudLocked;
+}
+
+// 扫描波特率逻辑 (增加清洗)
+void RadarSensor::scanBaudRate() {
+    isBaudLocked = false;
+    const long RATES[] = {256000, 115200};
+    int numRates = sizeof(RATES) / sizeof(RATES[0]);
+
+    Serial.printf("\n--- Scanning Baud Rate [S%d] ---\n", id);
+
+    int retryCount = 0;
+    const int MAX_RETRIES = 5; // 最多重试5次
+
+    while(!isBaudLocked && retryCount < MAX_RETRIES) {
+        for (int i = 0; i < numRates; i++) {
+            long rate = RATES[i];
+            Serial.printf("Trying %ld... ", rate);
+
+            end();
+            delay(200); // 增加关闭等待时间
+
+            begin(rate);
+
+            // [增强] 多重清理策略
+            delay(200); // 等待串口稳定
+            clearBuffer(); // 清理当前缓冲区
+            delay(300); // 额外等待，让雷达的旧数据流逝
+
+            // [增强] 再次清理，确保缓冲区干净
+            clearBuffer();
+            logFlush();
+
+            unsigned long scanStart = millis();
+            int matchCount = 0;
+            int cfgMatchCount = 0;
+            bool found = false;
+            int bytesReceived = 0;
+
+            while (waitRx(scanStart, 2000)) { // 增加扫描时间到2秒
+                uint8_t b = serial.read();
+                bytesReceived++;
+
+                if (matchCount == 0 && b == 0xAA) matchCount++;
+                else if (matchCount == 1 && b == 0xFF) matchCount++;
+                else if (matchCount == 2 && b == 0x03) matchCount++;
+                else if (matchCount == 3 && b == 0x00) { found = true; break; }
+                else { if (b == 0xAA) matchCount = 1; else matchCount = 0; }
+
+                if (cfgMatchCount == 0 && b == 0xFD) cfgMatchCount++;
+                else if (cfgMatchCount == 1 && b == 0xFC) cfgMatchCount++;
+                else if (cfgMatchCount == 2 && b == 0xFB) cfgMatchCount++;
+                else if (cfgMatchCount == 3 && b == 0xFA) { found = true; break; }
+                else { if (b == 0xFD) cfgMatchCount = 1; else cfgMatchCount = 0; }
+            }
+
+            if (found) {
+                Serial.printf("LOCKED! (received %d bytes)\n", bytesReceived);
+                currentBaudRate = rate;
+                isBaudLocked = true;
+                return;
+            } else {
+                Serial.printf("No (%d bytes received)\n", bytesReceived);
+            }
+        }
+
+        retryCount++;
+        if (retryCount < MAX_RETRIES) {
+            Serial.printf("\nScan failed. Auto-retrying in 3 seconds... (attempt %d/%d)\n", retryCount + 1, MAX_RETRIES);
+            Serial.println("(Press any key to stop scanning and enter console)");
+
+            unsigned long waitStart = millis();
+            while(millis() - waitStart < 3000) {
+                if (Serial.available()) {
+                    Serial.println("\n>> Scan aborted by user.");
+                    isBaudLocked = true;
+                    return;
+                }
+                waitLoopEvent(3000 - (millis() - waitStart));
+            }
+            Serial.println("\n--- Retrying Scan ---");
+        }
+    }
+
+    if (!isBaudLocked) {
+        Serial.println("\n>> Maximum retries exceeded. Entering console mode anyway.");
+        Serial.println("You may need to manually reset or check radar connection.");
+    }
+}
+
+String RadarSensor::getStatusInfo() {
+    unsigned long now = millis();
+    uint32_t fpsX10 = 0;
+    if (rateStart != 0 && now > rateStart) {
+        fpsX10 = (uint32_t)((uint64_t)(metrics.frames - rateFrames) * 10000 / (now - rateStart));
+    }
+
+    metrics.rxEvents = rxEventCount;
+    metrics.rxOverflows = rxOverflowCount;
+
+    // 丢帧率(估)：每次重同步至少损坏一帧，每次溢出至少丢一帧，按 丢弃/(完整帧+丢弃) 计千分比
+    uint32_t drops = metrics.resyncs + metrics.rxOverflows;
+    uint32_t windowDrops = drops - rateDrops;
+    uint32_t windowFrames = metrics.frames - rateFrames;
+    uint32_t dropPermille = (windowFrames + windowDrops) ?
+        (uint32_t)((uint64_t)windowDrops * 1000 / (windowFrames + windowDrops)) : 0;
+    uint32_t latencyAvgUs = metrics.latencySamples ? (uint32_t)(metrics.latencyTotalUs / metrics.latencySamples) : 0;
+
+    char line[400];
+    snprintf(line, sizeof(line),
+             "[RADAR S%d] RX=%d TX=%d 波特率=%ld%s 模式=%s 安装=(%d,%d,%d°)\n"
+             "           字节=%lu 帧=%lu 帧率=%lu.%lu/s 最大帧间隔=%lums 重同步=%lu ACK=%lu/%lu\n"
+             "           溢出=%lu 窗口丢帧率(估)=%lu.%lu%%\n"
+             "           接收事件=%lu 帧延迟 平均=%luus 最大=%luus",
+             id, rxPin, txPin, currentBaudRate, isBaudLocked ? "" : "(未锁定)",
+             lastKnownMode == 0x01 ? "单目标" : (lastKnownMode == 0x02 ? "多目标" : "未知"),
+             mount.offsetX, mount.offsetY, mount.rotationDeg,
+             (unsigned long)metrics.bytes, (unsigned long)metrics.frames,
+             (unsigned long)(fpsX10 / 10), (unsigned long)(fpsX10 % 10),
+             (unsigned long)metrics.maxFrameGapMs, (unsigned long)metrics.resyncs,
+             (unsigned long)metrics.acks, (unsigned long)(metrics.acks + metrics.ackFailures),
+             (unsigned long)metrics.rxOverflows, (unsigned long)(dropPermille / 10), (unsigned long)(dropPermille % 10),
+             (unsigned long)metrics.rxEvents, (unsigned long)latencyAvgUs, (unsigned long)metrics.latencyMaxUs);
+
+    // 帧率、丢帧率、最大帧间隔与帧延迟按统计窗口计算，每次查询后重新开始
+    rateFrames = metrics.frames;
+    rateDrops = drops;
+    rateStart = now;
+    metrics.maxFrameGapMs = 0;
+    metrics.latencyMaxUs = 0;
+    metrics.latencyTotalUs = 0;
+    metrics.latencySamples = 0;
+    return String(line);
+}
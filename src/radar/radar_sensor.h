@@ -0,0 +1,147 @@
+#ifndef RADAR_SENSOR_H
+#define RADAR_SENSOR_H
+
+#include <Arduino.h>
+#include "target.h"
+#include "ld2450_protocol.h"
+
+// ================= 单个 LD2450 传感器 =================
+// 每个实例独占一个 UART，拥有各自的波特率检测、帧解析、指令收发与指标。
+// ESP32-S3 上 Serial1/Serial2 可各接一个雷达(控制台改用 USB CDC 时 UART0 也可用)。
+
+#define RADAR_MAX_SENSORS   3
+#define RADAR_MAX_TARGETS   3
+#define RADAR_BUF_SIZE      64
+#define RADAR_FRAME_LEN     30
+#define RADAR_RX_CHUNK      128     // 每次从串口块读取的最大字节数
+#define RADAR_RX_BUFFER     2048    // UART 接收缓冲区
+#define RADAR_RX_TIMEOUT_SYMBOLS 3  // 接收超时(字符时间)：帧突发结束后触发 onReceive
+
+// 安装变换：传感器坐标 -> 房间坐标
+// 先按 rotationDeg 逆时针旋转，再平移 (offsetX, offsetY)
+struct MountTransform {
+    int16_t offsetX;       // 传感器在房间坐标系中的位置(mm)
+    int16_t offsetY;
+    int16_t rotationDeg;   // 朝向(度)，0 表示雷达Y轴与房间Y轴同向
+};
+
+// 传感器配置(见 radar_config.cpp)
+struct RadarSensorConfig {
+    HardwareSerial* port;
+    int8_t rxPin;
+    int8_t txPin;
+    MountTransform mount;
+};
+
+// 传感器指标
+struct RadarMetrics {
+    uint32_t bytes;            // 收到的字节数
+    uint32_t frames;           // 完整数据帧数
+    uint32_t resyncs;          // 帧头失配/缓冲溢出后的重新同步次数
+    uint32_t rxOverflows;      // UART 接收缓冲/FIFO 溢出次数(摄入跟不上时字节被硬件丢弃)
+    uint32_t acks;             // 成功的 ACK
+    uint32_t ackFailures;      // 失败/超时的 ACK
+    unsigned long lastFrameAt; // 最近一帧时间
+    uint32_t maxFrameGapMs;    // 统计窗口内相邻两帧最大间隔，用于判断摄入是否跟得上
+    uint32_t rxEvents;         // UART 接收事件数(onReceive)
+    uint32_t latencyMaxUs;     // 统计窗口内 接收事件 -> 帧交给处理 的最大延迟
+    uint64_t latencyTotalUs;   // 统计窗口内延迟累计
+    uint32_t latencySamples;
+};
+
+class RadarSensor {
+public:
+    RadarSensor(uint8_t id, const RadarSensorConfig& cfg);
+
+    // ---- 串口 ----
+    void begin(long baud);
+    void end();
+    // (重新)注册 UART 溢出回调；透传桥接会临时换成自己的回调，退出后须调用
+    void attachErrorHandler();
+    void clearBuffer();         // 清理串口中的脏数据
+    void resetParser();         // 丢弃未完成的半帧
+    bool hasPendingData();      // 串口或块缓冲中还有未解析的字节
+    // 等待串口数据直到 start 起 timeoutMs 超时；事件驱动时阻塞等待而不是空转
+    bool waitRx(unsigned long start, unsigned long timeoutMs);
+    HardwareSerial& port() { return serial; }
+
+    // ---- 数据帧 ----
+    // 从串口块读取并解析，完成一帧返回 true(剩余字节留待下次调用)
+    bool poll();
+    // 逐字节解析，完成一帧返回 true 并更新 targets
+    bool parseByte(uint8_t b);
+    // 在超时时间内等待一个完整数据帧
+    bool waitForFrame(unsigned long timeoutMs);
+    // 最近一帧的原始字节(RADAR_FRAME_LEN)
+    const uint8_t* frame() const { return buf; }
+    // 根据 lastKnownMode 决定有效目标数：0x01=单目标，0x02=多目标，-1=未知(默认多目标)
+    int targetCount() const { return (lastKnownMode == 0x01) ? 1 : RADAR_MAX_TARGETS; }
+    // 传感器坐标 -> 房间坐标
+    void toRoom(const Target& t, int16_t& x, int16_t& y) const;
+    void setMount(const MountTransform& m);
+
+    // ---- 指令(命令字与布局见 ld2450_protocol.h) ----
+    void sendPacket(uint16_t cmdWord, const uint8_t* value, uint16_t valueLen);
+    // 发送指令 C，命令值按布局编码后整帧写出
+    template <class C>
+    void send(const typename C::Request& req = typename C::Request()) {
+        uint8_t frame[ld2450::requestFrameLen<C>()];
+        serial.write(frame, ld2450::encodeRequest<C>(req, frame));
+    }
+    // 等待 cmd 的 ACK：按长度字段收帧并校验回显命令字/状态/数据长度，ackData 非空时拷出 ACK 数据
+    bool waitForAck(const ld2450::CommandDesc& cmd, unsigned long timeoutMs = 600, bool silent = false,
+                    uint8_t* ackData = NULL);
+    void enableConfig(bool silent = false);
+    void endConfig(bool silent = false);
+    // 进入配置模式执行一条指令再退出；value 长度须与描述表一致
+    bool runCmd(const ld2450::CommandDesc& cmd, const char* name, const uint8_t* value, uint16_t valueLen);
+    template <class C>
+    bool runCmd(const char* name, const typename C::Request& req = typename C::Request()) {
+        uint8_t value[C::Request::SIZE + 1];
+        ld2450::encodeValue<C>(req, value);
+        return runCmd(ld2450::descOf<C>(), name, value, C::Request::SIZE);
+    }
+    void performAutoCheck();    // 后台静默查询模式，变化时报警
+
+    // ---- 波特率 ----
+    bool hotStart();            // 开机：先试 256000(热重启)，失败再扫描
+    void scanBaudRate();
+
+    // 获取传感器状态与指标(帧率/最大帧间隔/帧延迟按上次调用以来的窗口计算)
+    String getStatusInfo();
+
+    const uint8_t id;
+    Target targets[RADAR_MAX_TARGETS];
+    long currentBaudRate;
+    bool isBaudLocked;
+    int lastKnownMode;          // -1 表示未知，用于对比配置变化
+    RadarMetrics metrics;
+    MountTransform mount;
+
+private:
+    void parseTargets();
+    void onUartEvent();
+    void onUartError(hardwareSerial_error_t err);
+    void recordLatency();
+    void onAck(const ld2450::CommandDesc& cmd, const uint8_t* data, bool silent);
+
+    HardwareSerial& serial;
+    int8_t rxPin;
+    int8_t txPin;
+    uint8_t buf[RADAR_BUF_SIZE];
+    int bufIdx;
+    uint8_t rx[RADAR_RX_CHUNK];
+    int rxLen;
+    int rxPos;
+    float cosR;
+    float sinR;
+    uint32_t rateFrames;        // 帧率统计窗口起点
+    uint32_t rateDrops;         // 窗口起点时的 重同步+溢出 次数
+    unsigned long rateStart;
+    volatile uint32_t rxEventUs;     // 最近一次接收事件时间(UART 事件任务写)
+    volatile uint32_t rxEventCount;
+    volatile uint32_t rxOverflowCount;  // UART 事件任务写
+    uint32_t eventsAtLastFrame;
+};
+
+#endif // RADAR_SENSOR_H
@@ -0,0 +1,54 @@
+#include "sensor_fusion.h"
+
+int fuseTargets(RadarSensor* const* sensors, int count, FusedTarget* out, unsigned long now) {
+    // 累加和用于求平均，避免逐次平均的累积误差
+    int32_t sumX[FUSION_MAX_TARGETS], sumY[FUSION_MAX_TARGETS], sumSpeed[FUSION_MAX_TARGETS];
+    uint8_t hits[FUSION_MAX_TARGETS];
+    int n = 0;
+    const int32_t radius2 = (int32_t)FUSION_MERGE_RADIUS_MM * FUSION_MERGE_RADIUS_MM;
+
+    for (int s = 0; s < count; s++) {
+        RadarSensor* sensor = sensors[s];
+        if (!sensor->isBaudLocked || sensor->metrics.frames == 0) continue;
+        // 有符号比较：now 可能略早于本轮刚解析出的帧时间
+        if ((long)(now - sensor->metrics.lastFrameAt) > FUSION_STALE_MS) continue;
+        uint8_t bit = 1 << sensor->id;
+
+        for (int i = 0; i < sensor->targetCount(); i++) {
+            const Target& t = sensor->targets[i];
+            if (isEmptyTarget(t)) continue;
+            int16_t x, y;
+            sensor->toRoom(t, x, y);
+
+            // 找最近的、尚未包含本传感器观测的融合目标
+            int best = -1;
+            int32_t bestD2 = radius2;
+            for (int k = 0; k < n; k++) {
+                if (out[k].sensorMask & bit) continue;
+                int32_t dx = x - out[k].x;
+                int32_t dy = y - out[k].y;
+                int32_t d2 = dx * dx + dy * dy;
+                if (d2 < bestD2) { best = k; bestD2 = d2; }
+            }
+
+            if (best < 0) {
+                if (n >= FUSION_MAX_TARGETS) continue;
+                best = n++;
+                sumX[best] = sumY[best] = sumSpeed[best] = 0;
+                hits[best] = 0;
+                out[best].sensorMask = 0;
+                out[best].resolution = 0;
+            }
+            sumX[best] += x;
+            sumY[best] += y;
+            sumSpeed[best] += t.speed;
+            hits[best]++;
+            out[best].x = sumX[best] / hits[best];
+            out[best].y = sumY[best] / hits[best];
+            out[best].speed = sumSpeed[best] / hits[best];
+            if (t.resolution > out[best].resolution) out[best].resolution = t.resolution;
+            out[best].sensorMask |= bit;
+        }
+    }
+    return n;
+}
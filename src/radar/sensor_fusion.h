@@ -0,0 +1,30 @@
+#ifndef SENSOR_FUSION_H
+#define SENSOR_FUSION_H
+
+#include <Arduino.h>
+#include "radar_sensor.h"
+
+// ================= 多传感器融合 =================
+// 将各传感器的目标经安装变换转换到房间坐标后合并：
+// 来自不同传感器、距离小于 FUSION_MERGE_RADIUS_MM 的目标视为同一人，取平均位置。
+// 同一传感器内的目标互不合并(雷达本身已区分)。
+// 速度为各传感器径向速度的平均，仅供参考。
+// 超过 FUSION_STALE_MS 没有新帧的传感器(断线/停发)不参与融合，避免其最后一帧目标一直留在结果里。
+
+#define FUSION_MERGE_RADIUS_MM  400
+#define FUSION_STALE_MS         500     // LD2450 约 10 帧/秒，5 个帧周期无新帧视为失效
+#define FUSION_MAX_TARGETS      (RADAR_MAX_SENSORS * RADAR_MAX_TARGETS)
+
+// 融合后的目标(房间坐标)
+struct FusedTarget {
+    int16_t x;
+    int16_t y;
+    int16_t speed;
+    int16_t resolution;
+    uint8_t sensorMask;     // 观测到该目标的传感器(bit0=S0)
+};
+
+// 融合全部已锁定传感器的当前目标，返回融合后的目标数
+int fuseTargets(RadarSensor* const* sensors, int count, FusedTarget* out, unsigned long now);
+
+#endif // SENSOR_FUSION_H
@@ -0,0 +1,19 @@
+#ifndef RADAR_TARGET_H
+#define RADAR_TARGET_H
+
+#include <stdint.h>
+
+// 目标数据结构
+struct Target {
+    int16_t x;
+    int16_t y;
+    int16_t speed;
+    int16_t resolution;
+};
+
+// 空目标：雷达对空槽位全部填 0，解析后坐标为 (0,0) 或距离分辨率为 0
+inline bool isEmptyTarget(const Target& t) {
+    return (t.x == 0 && t.y == 0) || t.resolution == 0;
+}
+
+#endif // RADAR_TARGET_H
@@ -0,0 +1,27 @@
+#include "binary_stream.h"
+
+// ================= 全局变量定义 =================
+BinaryStreamStats binaryStreamStats = {0, 0, 0};
+
+void streamFrameRecord(uint8_t sensorId, const Target* targets, uint8_t count) {
+    uint8_t enc[BIN_MAX_ENCODED_LEN];
+    size_t encLen = encodeFrameRecord(binaryStreamStats.seq++, millis(), sensorId, targets, count, enc);
+
+    // USB 主机未及时读取时丢弃整条记录，绝不阻塞雷达主循环
+    if (Serial.availableForWrite() < (int)encLen) {
+        binaryStreamStats.dropped++;
+        return;
+    }
+    Serial.write(enc, encLen);
+    binaryStreamStats.sent++;
+}
+
+String getBinaryStreamStatusInfo() {
+    String info = "[BIN] 二进制流: 已发送=";
+    info += binaryStreamStats.sent;
+    info += " 丢弃=";
+    info += binaryStreamStats.dropped;
+    info += " 下一序号=";
+    info += binaryStreamStats.seq;
+    return info;
+}
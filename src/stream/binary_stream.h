@@ -0,0 +1,29 @@
+#ifndef BINARY_STREAM_H
+#define BINARY_STREAM_H
+
+#include <Arduino.h>
+#include "record_codec.h"
+
+// ================= USB 二进制流模式 =================
+// 每个解码后的雷达帧编码为一条二进制记录，经 COBS 编码后前后各加一个 0x00 写入 Serial。
+// 前导 0x00 把之前混入的文本(不含 0x00)隔成单独的块，主机丢弃该块而不会连同下一条记录一起丢失。
+// 二进制流模式期间日志暂停输出(logHoldOutput)，后台文本输出也会检查 logOutputHeld() 跳过。
+// 记录格式与编码见 record_codec.h
+
+// 二进制流统计
+struct BinaryStreamStats {
+    uint32_t seq;          // 下一条记录序号
+    uint32_t sent;         // 已发送记录数
+    uint32_t dropped;      // USB 发送缓冲区不足而丢弃的记录数
+};
+
+extern BinaryStreamStats binaryStreamStats;
+
+// 发送一帧目标记录；发送缓冲区不足时丢弃(不阻塞)并计数，序号照常递增
+// 多个传感器共用一个序号空间
+void streamFrameRecord(uint8_t sensorId, const Target* targets, uint8_t count);
+
+// 获取二进制流统计信息
+String getBinaryStreamStatusInfo();
+
+#endif // BINARY_STREAM_H
@@ -0,0 +1,72 @@
+#include "record_codec.h"
+
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t codeIdx = 0;   // 当前分组的长度码位置
+    size_t outIdx = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[codeIdx] = code;
+            codeIdx = outIdx++;
+            code = 1;
+        } else {
+            out[outIdx++] = in[i];
+            if (++code == 0xFF) {
+                out[codeIdx] = code;
+                codeIdx = outIdx++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIdx] = code;
+    return outIdx;
+}
+
+uint16_t crc16Ccitt(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static size_t putU16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    return 2;
+}
+
+static size_t putU32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+    return 4;
+}
+
+size_t encodeFrameRecord(uint32_t seq, uint32_t ts, uint8_t sensorId, const Target* targets, uint8_t count, uint8_t* out) {
+    if (count > BIN_MAX_TARGETS) count = BIN_MAX_TARGETS;
+
+    uint8_t rec[BIN_MAX_RECORD_LEN];
+    size_t len = 0;
+    rec[len++] = BIN_RECORD_FRAME;
+    len += putU32(rec + len, seq);
+    len += putU32(rec + len, ts);
+    rec[len++] = sensorId;
+    rec[len++] = count;
+    for (uint8_t i = 0; i < count; i++) {
+        len += putU16(rec + len, (uint16_t)targets[i].x);
+        len += putU16(rec + len, (uint16_t)targets[i].y);
+        len += putU16(rec + len, (uint16_t)targets[i].speed);
+        len += putU16(rec + len, (uint16_t)targets[i].resolution);
+    }
+    len += putU16(rec + len, crc16Ccitt(rec, len));
+
+    out[0] = 0x00;
+    size_t encLen = 1 + cobsEncode(rec, len, out + 1);
+    out[encLen++] = 0x00;
+    return encLen;
+}
@@ -0,0 +1,35 @@
+#ifndef RECORD_CODEC_H
+#define RECORD_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../radar/target.h"
+
+// ================= 二进制流记录编码 =================
+// 不依赖 Arduino，编码/COBS/CRC 由 test/test_record_codec 在主机上检查。
+//
+// 记录格式(小端)：
+//   [0]     记录类型 BIN_RECORD_FRAME
+//   [1..4]  序号 seq (uint32，每帧 +1，主机据此检测丢帧)
+//   [5..8]  时间戳 millis() (uint32)
+//   [9]     传感器编号
+//   [10]    目标数 n
+//   [11..]  n × {x int16, y int16, speed int16, resolution uint16}(传感器坐标)
+//   [末2]   CRC16-CCITT(0xFFFF 初值)，覆盖之前所有字节
+// 主机端解码器见 tools/binary_stream_decoder.py
+
+#define BIN_RECORD_FRAME      0x01
+#define BIN_MAX_TARGETS       3
+#define BIN_MAX_RECORD_LEN    (11 + BIN_MAX_TARGETS * 8 + 2)
+#define BIN_MAX_ENCODED_LEN   (BIN_MAX_RECORD_LEN + BIN_MAX_RECORD_LEN / 254 + 3) // COBS 开销 + 前后 0x00 分隔符
+
+// COBS 编码，返回编码后长度(不含结尾 0x00)
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out);
+
+// CRC16-CCITT
+uint16_t crc16Ccitt(const uint8_t* data, size_t len);
+
+// 编码一条帧记录(COBS 编码，前后各一个 0x00)到 out(至少 BIN_MAX_ENCODED_LEN 字节)，返回长度
+size_t encodeFrameRecord(uint32_t seq, uint32_t ts, uint8_t sensorId, const Target* targets, uint8_t count, uint8_t* out);
+
+#endif // RECORD_CODEC_H
@@ -0,0 +1,44 @@
+#include "circuit_breaker.h"
+
+bool CircuitBreaker::allow(uint32_t now) {
+    if (st == BREAKER_CLOSED) return true;
+
+    if (st == BREAKER_OPEN) {
+        if (now - openedAt < backoff) return false;
+        // 退避结束，放行一次探测
+        st = BREAKER_HALF_OPEN;
+        return true;
+    }
+
+    // HALF_OPEN：探测请求已在进行，结果出来前不再放行
+    return false;
+}
+
+void CircuitBreaker::recordSuccess() {
+    st = BREAKER_CLOSED;
+    failures = 0;
+    backoff = 0;
+}
+
+bool CircuitBreaker::recordFailure(uint32_t now) {
+    failures++;
+
+    if (st == BREAKER_HALF_OPEN) {
+        // 探测失败：退避时间翻倍
+        backoff = backoff * 2 < BREAKER_MAX_BACKOFF_MS ? backoff * 2 : BREAKER_MAX_BACKOFF_MS;
+    } else if (failures >= BREAKER_FAILURE_THRESHOLD) {
+        backoff = BREAKER_BASE_BACKOFF_MS;
+    } else {
+        return false; // 未达到阈值，保持 CLOSED
+    }
+
+    st = BREAKER_OPEN;
+    openedAt = now;
+    return true;
+}
+
+uint32_t CircuitBreaker::remainingMs(uint32_t now) const {
+    if (st != BREAKER_OPEN) return 0;
+    uint32_t elapsed = now - openedAt;
+    return elapsed < backoff ? backoff - elapsed : 0;
+}
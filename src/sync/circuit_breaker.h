@@ -0,0 +1,45 @@
+#ifndef CIRCUIT_BREAKER_H
+#define CIRCUIT_BREAKER_H
+
+#include <stdint.h>
+
+// ================= 熔断器 =================
+// 连续失败达到阈值后熔断(OPEN)，退避结束转为 HALF_OPEN 放行一次探测请求；
+// 探测成功恢复 CLOSED，失败则退避时间翻倍(不超过上限)。
+// 时间由调用方传入(millis())，不依赖 Arduino，状态转换由 test/test_circuit_breaker 在主机上检查。
+
+#define BREAKER_FAILURE_THRESHOLD 3      // 连续失败多少次后熔断
+#define BREAKER_BASE_BACKOFF_MS   2000   // 首次熔断的退避时间
+#define BREAKER_MAX_BACKOFF_MS    60000  // 退避时间上限
+
+// 熔断器状态
+enum BreakerState {
+    BREAKER_CLOSED = 0,   // 正常放行
+    BREAKER_OPEN,         // 熔断中，拒绝上传直到退避结束
+    BREAKER_HALF_OPEN     // 退避结束，放行一次探测请求
+};
+
+class CircuitBreaker {
+public:
+    CircuitBreaker() : st(BREAKER_CLOSED), failures(0), openedAt(0), backoff(0) {}
+
+    // 是否允许本次请求(OPEN 状态退避结束时转为 HALF_OPEN 并放行)
+    bool allow(uint32_t now);
+    // 记录请求结果；recordFailure 在本次进入 OPEN 时返回 true
+    void recordSuccess();
+    bool recordFailure(uint32_t now);
+
+    BreakerState state() const { return st; }
+    int consecutiveFailures() const { return failures; }
+    uint32_t backoffMs() const { return backoff; }
+    // OPEN 状态剩余退避时间，其余状态为 0
+    uint32_t remainingMs(uint32_t now) const;
+
+private:
+    BreakerState st;
+    int failures;          // 连续失败次数
+    uint32_t openedAt;     // 进入 OPEN 的时间
+    uint32_t backoff;      // 当前退避时间
+};
+
+#endif // CIRCUIT_BREAKER_H
@@ -0,0 +1,242 @@
+#include "command_channel.h"
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include "upload_guard.h"
+#include "../sys/heap_telemetry.h"
+#include "../sys/loop_events.h"
+#include "../log/log_ring.h"
+#include "../wifi/wifi_config.h"
+
+// ================= 全局变量定义 =================
+// received/duplicates/dropped 由长轮询任务与主循环(捎带指令)在 acceptLock 内更新，其余字段只由主循环更新
+CommandStats commandStats = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+static QueueHandle_t cmdQueue = NULL;
+static QueueHandle_t ackQueue = NULL;
+static TaskHandle_t channelTask = NULL;
+static bool channelOnline = false;               // 服务器是否支持长轮询
+
+// 最近入队的指令ID，用于去重(长轮询与捎带可能投递同一条)
+#define RECENT_ID_COUNT 16
+static uint32_t recentIds[RECENT_ID_COUNT];
+static int recentIdPos = 0;
+// 去重检查、入队与记录ID须作为一个整体完成(两个来源可能同时投递同一条)；
+// 入队不能在临界区内进行，因此用互斥量
+static SemaphoreHandle_t acceptLock = NULL;
+
+// 已取出但尚未成功回报的 ACK
+static CommandAck pendingAcks[COMMAND_ACK_QUEUE_DEPTH];
+static int pendingAckCount = 0;
+
+// 以下两个函数须在 acceptLock 内调用
+static bool isRecentId(uint32_t id) {
+    if (id == 0) return false; // 旧版服务器无ID，不去重
+    for (int i = 0; i < RECENT_ID_COUNT; i++) {
+        if (recentIds[i] == id) return true;
+    }
+    return false;
+}
+
+static void rememberId(uint32_t id) {
+    if (id == 0) return;
+    recentIds[recentIdPos] = id;
+    recentIdPos = (recentIdPos + 1) % RECENT_ID_COUNT;
+}
+
+bool acceptRemoteCommand(JsonObjectConst cmd, uint8_t source) {
+    if (cmdQueue == NULL) return false;
+
+    RemoteCommand rc;
+    memset(&rc, 0, sizeof(rc));
+    rc.id = cmd["id"] | 0;
+    strlcpy(rc.type, cmd["command_type"] | "", sizeof(rc.type));
+    strlcpy(rc.arg, cmd["payload"]["mode"] | "", sizeof(rc.arg));
+    rc.sensor = cmd["payload"]["sensor"] | -1;
+    // 超出 int8_t 的 zone_type 记为缺省(执行时拒绝)，不截断成另一个合法值
+    JsonVariantConst zoneType = cmd["payload"]["zone_type"];
+    rc.zoneType = zoneType.is<int8_t>() ? zoneType.as<int8_t>() : -1;
+    JsonArrayConst zones = cmd["payload"]["zones"].as<JsonArrayConst>();
+    if (zones.size() > 3) {
+        rc.zoneCount = 0xFF;
+    } else {
+        for (JsonArrayConst z : zones) {
+            // 坐标缺失、不是整数或超出 int16_t 时整条指令作废，不截断成另一个区域
+            for (int k = 0; k < 4; k++) {
+                if (!z[k].is<int16_t>()) {
+                    rc.zoneCount = 0xFF;
+                    break;
+                }
+                rc.zones[rc.zoneCount][k] = z[k].as<int16_t>();
+            }
+            if (rc.zoneCount == 0xFF) break;
+            rc.zoneCount++;
+        }
+    }
+    rc.enqueueAgeMs = cmd["enqueue_age_ms"] | 0;
+    rc.receivedAt = millis();
+    rc.source = source;
+
+    if (rc.type[0] == '\0') return false;
+
+    // 只记录成功入队的ID：队列满丢弃的指令不回报 ACK，服务器重新投递时不能被当作重复
+    bool accepted = false;
+    xSemaphoreTake(acceptLock, portMAX_DELAY);
+    if (isRecentId(rc.id)) {
+        commandStats.duplicates++;
+    } else if (xQueueSend(cmdQueue, &rc, 0) != pdTRUE) {
+        commandStats.dropped++;
+    } else {
+        rememberId(rc.id);
+        commandStats.received++;
+        accepted = true;
+    }
+    xSemaphoreGive(acceptLock);
+
+    if (accepted) wakeMainLoop(); // 主循环可能正在等待事件
+    return accepted;
+}
+
+bool popRemoteCommand(RemoteCommand& cmd) {
+    if (cmdQueue == NULL) return false;
+    return xQueueReceive(cmdQueue, &cmd, 0) == pdTRUE;
+}
+
+void reportCommandAck(const RemoteCommand& cmd, bool ok, unsigned long execStart) {
+    unsigned long now = millis();
+    CommandAck ack;
+    ack.id = cmd.id;
+    ack.ok = ok;
+    ack.latencyMs = cmd.enqueueAgeMs + (now - cmd.receivedAt);
+    ack.execMs = now - execStart;
+
+    if (ok) commandStats.executed++;
+    else commandStats.failed++;
+    commandStats.lastLatencyMs = ack.latencyMs;
+    commandStats.totalLatencyMs += ack.latencyMs;
+    if (ack.latencyMs > commandStats.maxLatencyMs) commandStats.maxLatencyMs = ack.latencyMs;
+
+    // cmd.type 在栈上，不能走日志缓冲区；二进制流模式下跳过
+    if (!logOutputHeld()) Serial.printf("[CMD] #%lu %s -> %s (延迟 %lu ms, 执行 %lu ms)\n",
+                  (unsigned long)ack.id, cmd.type, ok ? "OK" : "FAILED",
+                  (unsigned long)ack.latencyMs, (unsigned long)ack.execMs);
+
+    // 无ID的旧版指令无需回报；长轮询离线时 ACK 队列可能满，丢弃的 ACK 计数(服务器收不到这些执行结果)
+    if (ack.id != 0 && ackQueue != NULL && xQueueSend(ackQueue, &ack, 0) != pdTRUE) commandStats.ackDropped++;
+}
+
+// 发起一次长轮询：携带待回报 ACK，返回本次收到的指令数，失败返回 -1
+static int pollOnce() {
+    CommandAck ack;
+    while (pendingAckCount < COMMAND_ACK_QUEUE_DEPTH && xQueueReceive(ackQueue, &ack, 0) == pdTRUE) {
+        pendingAcks[pendingAckCount++] = ack;
+    }
+
+    ArduinoJson::JsonDocument doc;
+    doc["device_mac"] = WiFi.macAddress();
+    doc["wait"] = COMMAND_POLL_WAIT_S;
+    auto arr = doc["acks"].to<ArduinoJson::JsonArray>();
+    for (int i = 0; i < pendingAckCount; i++) {
+        auto obj = arr.add<ArduinoJson::JsonObject>();
+        obj["id"] = pendingAcks[i].id;
+        obj["ok"] = pendingAcks[i].ok;
+        obj["latency_ms"] = pendingAcks[i].latencyMs;
+        obj["exec_ms"] = pendingAcks[i].execMs;
+    }
+    String payload;
+    serializeJson(doc, payload);
+
+    WiFiClient client;
+    HTTPClient http;
+    http.setConnectTimeout(SYNC_CONNECT_TIMEOUT_MS);
+    http.setTimeout((COMMAND_POLL_WAIT_S + 5) * 1000);
+    http.useHTTP10(true);
+    if (!wifiBeginServerRequest(http, client, SERVER_CMD_URL, SYNC_CONNECT_TIMEOUT_MS)) return -1;
+    http.addHeader("Content-Type", "application/json");
+
+    int httpCode = http.POST(payload);
+    if (httpCode != HTTP_CODE_OK) {
+        http.end();
+        return -1;
+    }
+    String resp;
+    bool complete = readResponseWithDeadline(http, resp, millis() + SYNC_TOTAL_DEADLINE_MS);
+    http.end();
+    if (!complete) return -1;
+
+    // 服务器已收到 ACK
+    pendingAckCount = 0;
+
+    ArduinoJson::JsonDocument respDoc;
+    if (deserializeJson(respDoc, resp)) return -1;
+
+    int count = 0;
+    for (JsonObjectConst cmd : respDoc["data"]["commands"].as<JsonArrayConst>()) {
+        if (acceptRemoteCommand(cmd, COMMAND_SOURCE_POLL)) count++;
+    }
+    return count;
+}
+
+static void commandChannelTask(void* arg) {
+    unsigned long backoffMs = 0;
+    for (;;) {
+        if (WiFi.status() != WL_CONNECTED) {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+
+        int count = pollOnce();
+        if (count < 0) {
+            // 服务器不支持或暂时不可用：退避，期间依赖数据上报捎带的指令
+            channelOnline = false;
+            backoffMs = (backoffMs == 0) ? 1000 : min(backoffMs * 2, (unsigned long)COMMAND_MAX_BACKOFF_MS);
+            vTaskDelay(pdMS_TO_TICKS(backoffMs));
+            continue;
+        }
+        channelOnline = true;
+        backoffMs = 0;
+
+        // 等待本批指令执行完毕，让 ACK 随下一次长轮询立即回报
+        if (count > 0) {
+            unsigned long waitStart = millis();
+            while ((int)uxQueueMessagesWaiting(ackQueue) < count && millis() - waitStart < COMMAND_ACK_WAIT_MS) {
+                vTaskDelay(pdMS_TO_TICKS(5));
+            }
+        }
+    }
+}
+
+void startCommandChannel() {
+    if (channelTask != NULL) return;
+    acceptLock = xSemaphoreCreateMutex();
+    cmdQueue = xQueueCreate(COMMAND_QUEUE_DEPTH, sizeof(RemoteCommand));
+    ackQueue = xQueueCreate(COMMAND_ACK_QUEUE_DEPTH, sizeof(CommandAck));
+    // 网络任务放在核心0，雷达主循环(loopTask)在核心1
+    xTaskCreatePinnedToCore(commandChannelTask, "cmd_channel", 8192, NULL, 1, &channelTask, 0);
+    heapRegisterTask(channelTask, HEAP_SUB_CMD);
+}
+
+String getCommandChannelStatusInfo() {
+    String info = "[CMD] 长轮询: ";
+    info += channelOnline ? "在线" : "离线(仅捎带)";
+    info += "  收到=";
+    info += commandStats.received;
+    info += " 成功=";
+    info += commandStats.executed;
+    info += " 失败=";
+    info += commandStats.failed;
+    info += " 重复=";
+    info += commandStats.duplicates;
+    info += " 丢弃=";
+    info += commandStats.dropped;
+    info += " ACK丢弃=";
+    info += commandStats.ackDropped;
+    uint32_t done = commandStats.executed + commandStats.failed;
+    info += "\n[CMD] 入队->雷达ACK: 最近=";
+    info += commandStats.lastLatencyMs;
+    info += " ms 平均=";
+    info += done ? (uint32_t)(commandStats.totalLatencyMs / done) : 0;
+    info += " ms 最长=";
+    info += commandStats.maxLatencyMs;
+    info += " ms";
+    return info;
+}
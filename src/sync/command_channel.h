@@ -0,0 +1,84 @@
+#ifndef COMMAND_CHANNEL_H
+#define COMMAND_CHANNEL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ================= 远程指令通道 =================
+// 独立 FreeRTOS 任务对服务器做长轮询(long-poll)，服务器有指令入队时立即返回，
+// 指令投递延迟不再受 uploadInterval 限制。一次响应可携带多条指令，
+// 执行结果(ACK)在下一次长轮询请求中批量回报。
+//
+// 协议(POST SERVER_CMD_URL)：
+//   请求: {"device_mac": "...", "wait": 25, "acks": [{"id": 1, "ok": true, "latency_ms": 42, "exec_ms": 30}]}
+//   响应: {"data": {"commands": [{"id": 1, "command_type": "SET_MODE", "payload": {"mode": "multi"}, "enqueue_age_ms": 3}]}}
+// payload.sensor 可选，指定目标传感器编号，缺省发往全部传感器
+// SET_ZONE 的 payload: {"zone_type": 0|1|2, "zones": [[x1, y1, x2, y2], ...]}，最多 3 个区域，
+//   zone_type 0=关闭 1=仅检测区域内 2=不检测区域内，坐标单位 mm(-32768..32767，超出时拒绝整条指令)
+// latency_ms = 服务器入队到投递的时长(enqueue_age_ms) + 设备收到到雷达 ACK 的时长
+
+#define COMMAND_POLL_WAIT_S      25     // 服务器最长挂起时间
+#define COMMAND_ACK_WAIT_MS      3000   // 收到指令后等待执行结果的最长时间，之后再发起下一次长轮询
+#define COMMAND_QUEUE_DEPTH      8      // 待执行指令队列深度
+#define COMMAND_ACK_QUEUE_DEPTH  16     // 待回报 ACK 队列深度
+#define COMMAND_MAX_BACKOFF_MS   60000  // 长轮询失败退避上限
+
+// 指令来源
+enum CommandSource {
+    COMMAND_SOURCE_POLL = 0,   // 长轮询通道
+    COMMAND_SOURCE_SYNC        // 数据上报响应中捎带
+};
+
+// 远程指令
+struct RemoteCommand {
+    uint32_t id;                 // 服务器分配的指令ID(0 表示旧版服务器未提供)
+    char type[16];               // command_type，如 REBOOT / SET_MODE
+    char arg[16];                // 附加参数，如 SET_MODE 的 mode
+    int8_t sensor;               // 目标传感器编号(payload.sensor)，-1 表示全部
+    int8_t zoneType;             // SET_ZONE 的 zone_type，-1 表示缺省
+    uint8_t zoneCount;           // SET_ZONE 的区域数(超过 3 个或坐标超出 int16_t 时为 0xFF，执行时拒绝)
+    int16_t zones[3][4];         // SET_ZONE 的区域对角坐标
+    uint32_t enqueueAgeMs;       // 投递时在服务器队列中已等待的时间
+    unsigned long receivedAt;    // 设备收到的时间(millis)
+    uint8_t source;              // CommandSource
+};
+
+// 指令执行结果
+struct CommandAck {
+    uint32_t id;
+    bool ok;
+    uint32_t latencyMs;          // 服务器入队 -> 雷达 ACK
+    uint32_t execMs;             // 开始执行 -> 雷达 ACK
+};
+
+// 指令延迟统计
+struct CommandStats {
+    uint32_t received;           // 收到的指令数
+    uint32_t duplicates;         // 重复投递被丢弃的指令数
+    uint32_t dropped;            // 队列满被丢弃的指令数
+    uint32_t executed;           // 执行成功数
+    uint32_t failed;             // 执行失败数
+    uint32_t ackDropped;         // ACK 队列满被丢弃的执行结果数
+    uint32_t lastLatencyMs;
+    uint32_t maxLatencyMs;
+    uint64_t totalLatencyMs;
+};
+
+extern CommandStats commandStats;
+
+// 启动长轮询任务(WiFi 初始化后调用)
+void startCommandChannel();
+
+// 解析一条 JSON 指令并放入待执行队列；重复ID会被丢弃
+bool acceptRemoteCommand(JsonObjectConst cmd, uint8_t source);
+
+// 主循环取出一条待执行指令(非阻塞)
+bool popRemoteCommand(RemoteCommand& cmd);
+
+// 主循环回报执行结果
+void reportCommandAck(const RemoteCommand& cmd, bool ok, unsigned long execStart);
+
+// 获取指令通道状态信息
+String getCommandChannelStatusInfo();
+
+#endif // COMMAND_CHANNEL_H
@@ -0,0 +1,110 @@
+#include "upload_guard.h"
+#include "../log/log_ring.h"
+
+// ================= 全局变量定义 =================
+UploadStats uploadStats = {0, 0, 0, 0, 0, 0, 0};
+
+static CircuitBreaker breaker;
+
+bool breakerAllowRequest() {
+    BreakerState prev = breaker.state();
+    if (!breaker.allow(millis())) {
+        uploadStats.skipped++;
+        return false;
+    }
+    if (prev == BREAKER_OPEN) LOG_I(LOG_MOD_SYNC, "[SYNC] 熔断退避结束，发送探测请求...\n");
+    return true;
+}
+
+void breakerRecordSuccess() {
+    if (breaker.state() != BREAKER_CLOSED) {
+        LOG_I(LOG_MOD_SYNC, "[SYNC] 服务器已恢复，熔断器关闭\n");
+    }
+    breaker.recordSuccess();
+}
+
+void breakerRecordFailure() {
+    if (breaker.recordFailure(millis())) {
+        LOG_W(LOG_MOD_SYNC, "[SYNC] 连续失败 %d 次，熔断 %lu ms\n", breaker.consecutiveFailures(),
+              (unsigned long)breaker.backoffMs());
+    }
+}
+
+BreakerState getBreakerState() {
+    return breaker.state();
+}
+
+void applyUploadTimeouts(HTTPClient& http) {
+    http.setConnectTimeout(SYNC_CONNECT_TIMEOUT_MS);
+    http.setTimeout(SYNC_IO_TIMEOUT_MS);
+    // HTTP/1.0：服务器不会使用 chunked 编码，响应以 Content-Length 或断开连接结束
+    http.useHTTP10(true);
+    http.setReuse(false);
+}
+
+uint32_t syncRemainingMs(unsigned long deadline) {
+    long left = (long)(deadline - millis());
+    return left > 0 ? (uint32_t)left : 0;
+}
+
+bool readResponseWithDeadline(HTTPClient& http, String& out, unsigned long deadline) {
+    int len = http.getSize(); // -1 表示未知长度，读到连接关闭为止
+    if (len > SYNC_MAX_RESPONSE_BYTES) return false;
+
+    WiFiClient* stream = http.getStreamPtr();
+    if (stream == NULL) return false;
+
+    out = "";
+    out.reserve(len > 0 ? len : 256);
+
+    char buf[129];
+    while ((long)(deadline - millis()) > 0) {
+        int avail = stream->available();
+        if (avail > 0) {
+            int n = stream->read((uint8_t*)buf, min(avail, (int)sizeof(buf) - 1));
+            if (n <= 0) continue;
+            buf[n] = '\0';
+            out += buf;
+            if (len > 0 && (int)out.length() >= len) return true;
+            if (out.length() > SYNC_MAX_RESPONSE_BYTES) return false;
+        } else if (!stream->connected()) {
+            return len < 0 || (int)out.length() >= len;
+        } else {
+            delay(1);
+        }
+    }
+    return false;
+}
+
+bool isServerFailure(int httpCode) {
+    // 负数为连接/发送/读取错误；5xx 为服务器内部故障
+    return httpCode <= 0 || httpCode >= 500;
+}
+
+String getUploadStatusInfo() {
+    String info = "[SYNC] 熔断器: ";
+    if (breaker.state() == BREAKER_CLOSED) {
+        info += "CLOSED";
+    } else if (breaker.state() == BREAKER_OPEN) {
+        info += "OPEN (剩余 ";
+        info += breaker.remainingMs(millis());
+        info += " ms)";
+    } else {
+        info += "HALF_OPEN";
+    }
+    info += "\n[SYNC] 上传: 尝试=";
+    info += uploadStats.attempts;
+    info += " 成功=";
+    info += uploadStats.successes;
+    info += " 失败=";
+    info += uploadStats.failures;
+    info += " 熔断跳过=";
+    info += uploadStats.skipped;
+    info += "\n[SYNC] 耗时: 最近=";
+    info += uploadStats.lastDurationMs;
+    info += " ms 最长=";
+    info += uploadStats.maxDurationMs;
+    info += " ms 最近状态码=";
+    info += uploadStats.lastHttpCode;
+    return info;
+}
@@ -0,0 +1,58 @@
+#ifndef UPLOAD_GUARD_H
+#define UPLOAD_GUARD_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include "circuit_breaker.h"
+
+// ================= 上传截止时间 =================
+// 上传在独立任务中执行(见 upload_task.h)，以下超时限制的是上传任务被一次请求占住的时间，
+// 并把慢服务器计为失败交给熔断器；雷达主循环不等待网络。
+// 建连、发送/等待响应头与读取响应体各自只拿到截止时间前剩余的预算，每一步之后检查截止时间，
+// 超过即断开连接并计为失败。HTTPClient 等待响应头的超时在每收到一行时重新计时，
+// 只有逐行慢慢吐出响应头的服务器还能让 POST() 越过截止时间(返回后同样计为失败)；
+// 按主机名解析(未缓存服务器地址时)的 DNS 查询也不受约束。
+#define SYNC_CONNECT_TIMEOUT_MS   800   // TCP 建连超时
+#define SYNC_IO_TIMEOUT_MS        1000  // 发送/单次读取的套接字超时
+#define SYNC_TOTAL_DEADLINE_MS    1500  // 响应须在发起请求后该时间内读完，否则计为失败
+#define SYNC_MAX_RESPONSE_BYTES   2048  // 响应体上限，防止异常服务器拖住读取
+
+// 上传统计
+struct UploadStats {
+    uint32_t attempts;            // 实际发起的上传次数
+    uint32_t successes;           // 成功次数
+    uint32_t failures;            // 失败次数(超时/连接失败/5xx)
+    uint32_t skipped;             // 被熔断器拦截的次数
+    uint32_t lastDurationMs;      // 最近一次上传耗时
+    uint32_t maxDurationMs;       // 历史最长上传耗时(上传任务中，不阻塞主循环)
+    int lastHttpCode;             // 最近一次 HTTP 状态码(负数为 HTTPClient 错误)
+};
+
+extern UploadStats uploadStats;
+
+// 熔断器：是否允许本次上传(OPEN 状态退避结束时自动转为 HALF_OPEN)
+bool breakerAllowRequest();
+
+// 熔断器：记录上传结果
+void breakerRecordSuccess();
+void breakerRecordFailure();
+
+// 当前熔断器状态
+BreakerState getBreakerState();
+
+// 为 HTTPClient 设置建连与读写超时
+void applyUploadTimeouts(HTTPClient& http);
+
+// 距截止时间剩余的毫秒数，已过返回 0
+uint32_t syncRemainingMs(unsigned long deadline);
+
+// 在截止时间前读取响应体；超时或超长返回 false
+bool readResponseWithDeadline(HTTPClient& http, String& out, unsigned long deadline);
+
+// 判断 HTTP 结果是否应计为服务器故障
+bool isServerFailure(int httpCode);
+
+// 获取上传/熔断状态信息
+String getUploadStatusInfo();
+
+#endif // UPLOAD_GUARD_H
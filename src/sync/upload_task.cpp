@@ -0,0 +1,120 @@
+#include "upload_task.h"
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include "upload_guard.h"
+#include "../sys/heap_telemetry.h"
+#include "../sys/loop_events.h"
+#include "../wifi/wifi_config.h"
+
+// 待执行的上传(payload 放在 jobPayload，队列只传类型与附带值)
+struct UploadJob {
+    uint8_t kind;
+    uint32_t tag;
+};
+
+static QueueHandle_t jobQueue = NULL;
+static QueueHandle_t resultQueue = NULL;
+static TaskHandle_t uploadTaskHandle = NULL;
+static bool inFlight = false;      // 只由主循环读写
+
+// 主循环在提交前写入、任务在取到任务后读取；结果入队前由任务写入 resultResp，
+// 主循环取到结果后读取。队列收发保证两侧不会同时访问
+static String jobPayload;
+static String resultResp;
+
+static const char* urlOf(uint8_t kind) {
+    return kind == UPLOAD_KIND_HEATMAP ? SERVER_HEATMAP_URL : SERVER_URL;
+}
+
+// 执行一次 POST，响应须在发起后 SYNC_TOTAL_DEADLINE_MS 内读完，否则断开连接并计为失败(交给熔断器)。
+// 建连与 POST 只拿到剩余预算，每一步之后检查截止时间
+static void runUpload(const UploadJob& job, UploadResult& r) {
+    unsigned long start = millis();
+    unsigned long deadline = start + SYNC_TOTAL_DEADLINE_MS;
+    resultResp = "";
+
+    if (WiFi.status() != WL_CONNECTED) {
+        r.ok = false;
+        r.httpCode = HTTPC_ERROR_NOT_CONNECTED;
+        r.durationMs = 0;
+        return;
+    }
+
+    WiFiClient client;
+    HTTPClient http;
+    applyUploadTimeouts(http);
+
+    bool ok = false;
+    int httpCode;
+    // 建连(含直连缓存地址失败后按主机名重连)合计不超过 SYNC_CONNECT_TIMEOUT_MS，见 wifiBeginServerRequest
+    bool begun = wifiBeginServerRequest(http, client, urlOf(job.kind), SYNC_CONNECT_TIMEOUT_MS);
+    uint32_t left = syncRemainingMs(deadline);
+    if (!begun) {
+        httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+    } else if (left == 0) {
+        httpCode = HTTPC_ERROR_READ_TIMEOUT;
+    } else {
+        // 发送与等待响应头的超时不超过剩余预算
+        http.setTimeout((uint16_t)min(left, (uint32_t)SYNC_IO_TIMEOUT_MS));
+        http.addHeader("Content-Type", "application/json");
+        httpCode = http.POST(jobPayload);
+        ok = !isServerFailure(httpCode);
+        if (ok && (syncRemainingMs(deadline) == 0 || !readResponseWithDeadline(http, resultResp, deadline))) {
+            ok = false;
+            httpCode = HTTPC_ERROR_READ_TIMEOUT;
+        }
+    }
+    // 超时或失败时立即断开，不等服务器把响应发完
+    if (!ok) client.stop();
+    http.end();
+
+    r.ok = ok;
+    r.httpCode = httpCode;
+    r.durationMs = millis() - start;
+}
+
+static void uploadTask(void* arg) {
+    UploadJob job;
+    for (;;) {
+        if (xQueueReceive(jobQueue, &job, portMAX_DELAY) != pdTRUE) continue;
+
+        UploadResult r;
+        r.kind = job.kind;
+        r.tag = job.tag;
+        runUpload(job, r);
+        jobPayload = "";    // 释放请求体
+
+        xQueueSend(resultQueue, &r, portMAX_DELAY);
+        wakeMainLoop();     // 主循环可能正在等待事件
+    }
+}
+
+void startUploadTask() {
+    if (uploadTaskHandle != NULL) return;
+    jobQueue = xQueueCreate(1, sizeof(UploadJob));
+    resultQueue = xQueueCreate(1, sizeof(UploadResult));
+    // 与长轮询任务一样放在核心0，雷达主循环(loopTask)在核心1
+    xTaskCreatePinnedToCore(uploadTask, "sync_upload", UPLOAD_TASK_STACK, NULL, 1, &uploadTaskHandle, 0);
+    heapRegisterTask(uploadTaskHandle, HEAP_SUB_SYNC);
+}
+
+bool uploadBusy() {
+    return inFlight;
+}
+
+bool uploadSubmit(uint8_t kind, String& payload, uint32_t tag) {
+    if (jobQueue == NULL || inFlight) return false;
+    jobPayload = std::move(payload);
+    UploadJob job = {kind, tag};
+    xQueueSend(jobQueue, &job, 0);   // 没有进行中的上传，队列必为空
+    inFlight = true;
+    return true;
+}
+
+bool uploadPollResult(UploadResult& result, String& resp) {
+    if (resultQueue == NULL || !inFlight) return false;
+    if (xQueueReceive(resultQueue, &result, 0) != pdTRUE) return false;
+    resp = std::move(resultResp);
+    inFlight = false;
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef UPLOAD_TASK_H
+#define UPLOAD_TASK_H
+
+#include <Arduino.h>
+
+// ================= 上传任务 =================
+// 数据上报与热力图快照的 HTTP 请求在核心0上的独立任务中执行，雷达主循环(核心1)只组装 payload、
+// 处理结果，从不等待网络。
+// 每次请求受 SYNC_TOTAL_DEADLINE_MS 约束(见 upload_guard.h)，超时的请求断开连接并计为失败；
+// 即使个别请求越过截止时间，也只推迟下一次上传，不会拖住雷达摄入。
+// 同一时刻最多一个请求在进行；结果经队列交回主循环，熔断器与上传统计只由主循环读写。
+
+#define UPLOAD_TASK_STACK   8192
+
+// 上传类型
+enum UploadKind {
+    UPLOAD_KIND_SYNC = 0,     // 数据上报(SERVER_URL)
+    UPLOAD_KIND_HEATMAP       // 热力图快照(SERVER_HEATMAP_URL)
+};
+
+// 上传结果
+struct UploadResult {
+    uint8_t kind;             // UploadKind
+    bool ok;                  // 状态码非服务器故障，且响应在截止时间内读完
+    int httpCode;             // 负数为 HTTPClient 错误
+    uint32_t durationMs;      // 从发起请求到读完响应
+    uint32_t tag;             // 提交时的附带值，原样返回
+};
+
+// 启动上传任务(WiFi 初始化后调用)
+void startUploadTask();
+
+// 是否有上传在进行(提交后到主循环取走结果前)
+bool uploadBusy();
+
+// 提交上传：取走 payload 的内容，有上传在进行时返回 false
+bool uploadSubmit(uint8_t kind, String& payload, uint32_t tag);
+
+// 主循环取回上传结果(非阻塞)，resp 为响应体
+bool uploadPollResult(UploadResult& result, String& resp);
+
+#endif // UPLOAD_TASK_H
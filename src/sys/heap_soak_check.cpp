@@ -0,0 +1,27 @@
+#include "heap_soak_check.h"
+
+uint8_t heapFragPct(uint32_t freeBytes, uint32_t largestBlock) {
+    if (freeBytes == 0 || largestBlock >= freeBytes) return 0;
+    return (uint8_t)(100 - (uint64_t)largestBlock * 100 / freeBytes);
+}
+
+void HeapSoakCheck::begin(uint32_t freeHeap, uint32_t largestBlock) {
+    startFree = minFreeFirst = minFreeSecond = freeHeap;
+    startLargest = minLargest = largestBlock;
+    freeDelta = largestDelta = peakFirst = peakSecond = 0;
+}
+
+void HeapSoakCheck::sample(bool secondHalf, uint32_t freeHeap, uint32_t largestBlock) {
+    uint32_t& minFree = secondHalf ? minFreeSecond : minFreeFirst;
+    if (freeHeap < minFree) minFree = freeHeap;
+    if (largestBlock < minLargest) minLargest = largestBlock;
+}
+
+bool HeapSoakCheck::finish(uint32_t freeHeap, uint32_t largestBlock) {
+    freeDelta = (int32_t)(freeHeap - startFree);
+    largestDelta = (int32_t)(largestBlock - startLargest);
+    peakFirst = (int32_t)(startFree - minFreeFirst);
+    peakSecond = (int32_t)(startFree - minFreeSecond);
+    return freeDelta > -HEAP_SOAK_TOLERANCE && largestDelta > -HEAP_SOAK_TOLERANCE &&
+           peakSecond - peakFirst <= HEAP_SOAK_TOLERANCE;
+}
@@ -0,0 +1,39 @@
+#ifndef HEAP_SOAK_CHECK_H
+#define HEAP_SOAK_CHECK_H
+
+#include <stdint.h>
+
+// ================= 浸泡测试判定 =================
+// soak 命令在设备上回放合成帧(堆行为取决于真实的分配器，只能在设备上跑)，
+// 这里只是对采样结果的判定，不依赖 Arduino，由 test/test_heap_soak_check 在主机上检查。
+// 通过条件：结束时空闲堆与最大空闲块都没有下降超过容差，且后半程的峰值占用不比前半程高出容差以上
+// (持续泄漏或碎片化会让后半程越来越高)。
+
+#define HEAP_SOAK_TOLERANCE 1024   // 允许的堆波动(字节)
+
+// 碎片率(%) = 1 - 最大空闲块/空闲
+uint8_t heapFragPct(uint32_t freeBytes, uint32_t largestBlock);
+
+class HeapSoakCheck {
+public:
+    // 回放开始前的空闲堆与最大空闲块
+    void begin(uint32_t freeHeap, uint32_t largestBlock);
+    // 回放期间的采样
+    void sample(bool secondHalf, uint32_t freeHeap, uint32_t largestBlock);
+    // 回放结束后的空闲堆与最大空闲块，返回是否通过
+    bool finish(uint32_t freeHeap, uint32_t largestBlock);
+
+    int32_t freeDelta;        // 结束 - 开始
+    int32_t largestDelta;
+    int32_t peakFirst;        // 前/后半程相对开始时的最大占用增量
+    int32_t peakSecond;
+    uint32_t minLargest;      // 期间最小的最大空闲块
+
+private:
+    uint32_t startFree;
+    uint32_t startLargest;
+    uint32_t minFreeFirst;
+    uint32_t minFreeSecond;
+};
+
+#endif // HEAP_SOAK_CHECK_H
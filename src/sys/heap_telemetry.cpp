@@ -0,0 +1,136 @@
+#include "heap_telemetry.h"
+#include "heap_soak_check.h"
+#include <esp_heap_caps.h>
+#include <atomic>
+
+// ================= 全局变量定义 =================
+static std::atomic<uint32_t> subAllocs[HEAP_SUB_COUNT];
+static std::atomic<uint32_t> subBytes[HEAP_SUB_COUNT];
+static volatile uint8_t loopSubsystem = HEAP_SUB_OTHER;   // 主循环当前子系统
+static TaskHandle_t loopTask = NULL;
+
+#define HEAP_MAX_TASKS 4
+static TaskHandle_t taskHandles[HEAP_MAX_TASKS];
+static uint8_t taskSubs[HEAP_MAX_TASKS];
+static int taskCount = 0;
+
+static const char* const SUB_NAMES[HEAP_SUB_COUNT] = {"other", "console", "radar", "sync", "cmd", "wifi"};
+
+void heapTelemetryInit() {
+    loopTask = xTaskGetCurrentTaskHandle();
+}
+
+void heapRegisterTask(TaskHandle_t task, uint8_t sub) {
+    if (taskCount < HEAP_MAX_TASKS) {
+        taskSubs[taskCount] = sub;
+        taskHandles[taskCount] = task;
+        taskCount++;
+    }
+}
+
+HeapScope::HeapScope(uint8_t sub) : prev(loopSubsystem) {
+    loopSubsystem = sub;
+}
+
+HeapScope::~HeapScope() {
+    loopSubsystem = prev;
+}
+
+#ifdef HEAP_TRACK_ALLOC
+// 调度器启动前或中断中调用时不查询任务
+static inline uint8_t currentSubsystem() {
+    if (xPortInIsrContext() || xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) return HEAP_SUB_OTHER;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (self == loopTask) return loopSubsystem;
+    for (int i = 0; i < taskCount; i++) {
+        if (taskHandles[i] == self) return taskSubs[i];
+    }
+    return HEAP_SUB_OTHER;
+}
+
+static inline void countAlloc(size_t size) {
+    uint8_t sub = currentSubsystem();
+    subAllocs[sub].fetch_add(1, std::memory_order_relaxed);
+    subBytes[sub].fetch_add(size, std::memory_order_relaxed);
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    countAlloc(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    countAlloc(n * size);
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    countAlloc(size);
+    return __real_realloc(ptr, size);
+}
+}
+#endif
+
+HeapSnapshot takeHeapSnapshot() {
+    HeapSnapshot s;
+    s.freeHeap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s.minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s.psramSize = ESP.getPsramSize();
+    s.psramFree = ESP.getFreePsram();
+    s.psramLargest = ESP.getMaxAllocPsram();
+    s.fragPct = heapFragPct(s.freeHeap, s.largestBlock);
+    return s;
+}
+
+HeapSubStats getHeapSubStats(uint8_t sub) {
+    HeapSubStats st = {0, 0};
+    if (sub < HEAP_SUB_COUNT) {
+        st.allocs = subAllocs[sub].load(std::memory_order_relaxed);
+        st.bytes = subBytes[sub].load(std::memory_order_relaxed);
+    }
+    return st;
+}
+
+void addHeapToJson(JsonObject obj) {
+    HeapSnapshot s = takeHeapSnapshot();
+    obj["uptime_s"] = millis() / 1000;
+    obj["free"] = s.freeHeap;
+    obj["largest"] = s.largestBlock;
+    obj["min_free"] = s.minFreeHeap;
+    obj["frag_pct"] = s.fragPct;
+    obj["psram_free"] = s.psramFree;
+    obj["psram_size"] = s.psramSize;
+#ifdef HEAP_TRACK_ALLOC
+    auto allocs = obj["allocs"].to<JsonObject>();
+    for (int i = 0; i < HEAP_SUB_COUNT; i++) {
+        allocs[SUB_NAMES[i]] = subAllocs[i].load(std::memory_order_relaxed);
+    }
+#endif
+}
+
+String getHeapStatusInfo() {
+    HeapSnapshot s = takeHeapSnapshot();
+    char line[160];
+    snprintf(line, sizeof(line), "[HEAP] 空闲=%lu 最大块=%lu 碎片=%u%% 历史最低=%lu  PSRAM: %lu/%lu 空闲(最大块 %lu)",
+             (unsigned long)s.freeHeap, (unsigned long)s.largestBlock, s.fragPct, (unsigned long)s.minFreeHeap,
+             (unsigned long)s.psramFree, (unsigned long)s.psramSize, (unsigned long)s.psramLargest);
+    String info = line;
+#ifdef HEAP_TRACK_ALLOC
+    info += "\n[HEAP] 分配次数:";
+    for (int i = 0; i < HEAP_SUB_COUNT; i++) {
+        info += " ";
+        info += SUB_NAMES[i];
+        info += "=";
+        info += subAllocs[i].load(std::memory_order_relaxed);
+    }
+#else
+    info += "\n[HEAP] 分配计数未启用 (诊断固件 pio run -e heap_soak)";
+#endif
+    return info;
+}
@@ -0,0 +1,71 @@
+#ifndef HEAP_TELEMETRY_H
+#define HEAP_TELEMETRY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ================= 堆内存遥测 =================
+// 统计空闲堆、最大空闲块(碎片)、历史最低空闲、PSRAM 使用，以及按子系统的分配次数。
+// 分配次数通过链接器包装 malloc/calloc/realloc 获得，只在诊断环境中开启(pio run -e heap_soak)：
+//   -DHEAP_TRACK_ALLOC -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
+// 默认环境不包装，其余堆指标(空闲/最大块/碎片/PSRAM)照常可用
+// 主循环中的代码用 HeapScope 标记当前子系统；注册过的任务按任务归属计数；其余计入 other。
+
+#define HEAP_REPORT_INTERVAL_MS  10000   // 上传中附带堆信息的间隔
+
+// 子系统
+enum HeapSubsystem {
+    HEAP_SUB_OTHER = 0,   // 未标记(系统任务/WiFi驱动/lwIP 等)
+    HEAP_SUB_CONSOLE,     // 串口控制台
+    HEAP_SUB_RADAR,       // 雷达数据解析/输出
+    HEAP_SUB_SYNC,        // 数据上报
+    HEAP_SUB_CMD,         // 远程指令
+    HEAP_SUB_WIFI,        // WiFi 重连/状态
+    HEAP_SUB_COUNT
+};
+
+// 堆快照
+struct HeapSnapshot {
+    uint32_t freeHeap;        // 内部RAM空闲
+    uint32_t largestBlock;    // 内部RAM最大空闲块
+    uint32_t minFreeHeap;     // 启动以来最低空闲
+    uint32_t psramSize;
+    uint32_t psramFree;
+    uint32_t psramLargest;
+    uint8_t fragPct;          // 碎片率 = 1 - 最大块/空闲
+};
+
+// 子系统分配统计
+struct HeapSubStats {
+    uint32_t allocs;          // 分配次数(malloc/calloc/realloc)
+    uint32_t bytes;           // 累计申请字节数
+};
+
+// 记录主循环任务(setup 中调用)
+void heapTelemetryInit();
+
+// 将某个任务的全部分配计入指定子系统
+void heapRegisterTask(TaskHandle_t task, uint8_t sub);
+
+// 获取当前堆快照
+HeapSnapshot takeHeapSnapshot();
+
+// 获取子系统分配统计(未开启 HEAP_TRACK_ALLOC 时全为0)
+HeapSubStats getHeapSubStats(uint8_t sub);
+
+// 将堆信息写入上传 JSON
+void addHeapToJson(JsonObject obj);
+
+// 获取堆信息
+String getHeapStatusInfo();
+
+// 作用域内主循环的分配计入指定子系统
+class HeapScope {
+public:
+    explicit HeapScope(uint8_t sub);
+    ~HeapScope();
+private:
+    uint8_t prev;
+};
+
+#endif // HEAP_TELEMETRY_H
@@ -0,0 +1,59 @@
+#include "loop_events.h"
+
+// ================= 全局变量定义 =================
+LoopStats loopStats = {0, 0, 0, 0};
+static TaskHandle_t loopTask = NULL;
+
+void loopEventsInit() {
+    loopTask = xTaskGetCurrentTaskHandle();
+    loopStats.windowStartUs = esp_timer_get_time();
+}
+
+void wakeMainLoop() {
+#ifndef RADAR_POLLING_INGEST
+    if (loopTask != NULL) xTaskNotifyGive(loopTask);
+#endif
+}
+
+bool waitLoopEvent(uint32_t timeoutMs) {
+#ifdef RADAR_POLLING_INGEST
+    (void)timeoutMs;
+    return false;
+#else
+    int64_t start = esp_timer_get_time();
+    // 事件在检查与等待之间到达时通知计数已置位，不会丢失
+    bool woken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs)) > 0;
+    loopStats.idleUs += (uint64_t)(esp_timer_get_time() - start);
+    if (woken) loopStats.wakeups++;
+    else loopStats.timeouts++;
+    return woken;
+#endif
+}
+
+String getLoopStatusInfo() {
+    int64_t now = esp_timer_get_time();
+    uint64_t elapsed = (uint64_t)(now - loopStats.windowStartUs);
+    uint32_t busyPermille = 1000;
+    if (elapsed > 0 && loopStats.idleUs < elapsed) {
+        busyPermille = (uint32_t)(1000 - loopStats.idleUs * 1000 / elapsed);
+    } else if (elapsed > 0) {
+        busyPermille = 0;
+    }
+
+    char line[160];
+#ifdef RADAR_POLLING_INGEST
+    const char* mode = "轮询";
+#else
+    const char* mode = "事件驱动";
+#endif
+    snprintf(line, sizeof(line), "[LOOP] 摄入=%s 主循环占用率=%lu.%lu%% 唤醒=%lu 超时=%lu 窗口=%lums",
+             mode, (unsigned long)(busyPermille / 10), (unsigned long)(busyPermille % 10),
+             (unsigned long)loopStats.wakeups, (unsigned long)loopStats.timeouts,
+             (unsigned long)(elapsed / 1000));
+
+    loopStats.wakeups = 0;
+    loopStats.timeouts = 0;
+    loopStats.idleUs = 0;
+    loopStats.windowStartUs = now;
+    return String(line);
+}
@@ -0,0 +1,42 @@
+#ifndef LOOP_EVENTS_H
+#define LOOP_EVENTS_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// ================= 主循环事件等待 =================
+// 主循环在无事可做时阻塞在任务通知上，由以下事件唤醒：
+//   - 雷达串口 onReceive(UART 接收超时/FIFO 阈值；LD2450 帧按连续突发发送时预期每帧结束触发一次)
+//   - 控制台串口 onReceive(USB CDC 控制台无此回调，依靠 LOOP_IDLE_TIMEOUT_MS 兜底)
+//   - 远程指令入队
+// 等待超时用于驱动 WiFi 检查、自动检测等定时任务。
+// 构建时定义 RADAR_POLLING_INGEST 可回退为轮询(从不阻塞)，用于对比 CPU 占用与帧延迟
+// (pio run -e polling_ingest)。轮询时主循环从不让出核心1，占用率恒为 100%。
+// 两种摄入方式的占用率、唤醒次数与帧延迟尚未在设备上实测对比，事件驱动的收益以实测为准。
+
+#define LOOP_IDLE_TIMEOUT_MS    20      // 无事件时最长休眠
+#define LOOP_LOG_RETRY_MS       2       // 日志积压(串口发送缓冲区满)时的重试间隔
+
+// 主循环统计(窗口：上次查询以来)
+struct LoopStats {
+    uint32_t wakeups;       // 被事件唤醒次数
+    uint32_t timeouts;      // 等待超时次数
+    uint64_t idleUs;        // 阻塞等待的累计时间
+    int64_t windowStartUs;  // 统计窗口起点(esp_timer_get_time，64 位不回绕；micros() 约 71 分钟回绕)
+};
+
+extern LoopStats loopStats;
+
+// 记录主循环任务(setup 开头调用)
+void loopEventsInit();
+
+// 唤醒主循环(任意任务/回调中调用，不可在 ISR 中调用)
+void wakeMainLoop();
+
+// 主循环阻塞等待事件，最长 timeoutMs；被唤醒返回 true。轮询模式下立即返回 false
+bool waitLoopEvent(uint32_t timeoutMs);
+
+// 获取主循环占用率与唤醒统计(查询后重新开始窗口)
+String getLoopStatusInfo();
+
+#endif // LOOP_EVENTS_H
@@ -1,64 +1,365 @@
 #include "wifi_config.h"
+#include <Preferences.h>
+#include <esp_rom_crc.h>
+#include "../sys/loop_events.h"
+#include "../log/log_ring.h"
 
 // ================= 全局变量定义 =================
 // 请修改以下配置以连接到您的WiFi网络
 const char* WIFI_SSID = "YourWiFiSSID";        // 🔧 修改为您的WiFi名称
 const char* WIFI_PASS = "YourWiFiPassword";    // 🔧 修改为您的WiFi密码
 const char* SERVER_URL = "http://link2you.top:5000/api/v1/device/sync"; // 🔧 服务器地址（通常不需要修改）
+const char* SERVER_CMD_URL = "http://link2you.top:5000/api/v1/device/commands"; // 远程指令长轮询地址
+const char* SERVER_HEATMAP_URL = "http://link2you.top:5000/api/v1/device/heatmap"; // 占用热力图快照地址
 String deviceMac = "";                      // 设备MAC地址
 unsigned long lastUploadTime = 0;           // 上次上传时间
 unsigned long uploadInterval = 1000;        // 默认1秒上传间隔
+WiFiConnectStats wifiStats;
 
-// WiFi连接状态检测与自动重连
-void checkWiFiAndReconnect() {
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("[WiFi] 连接丢失，正在尝试重连...");
-        WiFi.disconnect();
+// ================= 快速重连缓存 =================
+#define WIFI_CACHE_MAGIC    0x57464331  // "WFC1"
+#define WIFI_NVS_NAMESPACE  "wifi_fast"
+
+// 字段按 4 字节对齐排列，无填充，可直接 memcmp/CRC
+struct WiFiFastCache {
+    uint32_t magic;
+    uint32_t configHash;    // SSID/密码/服务器主机名的 CRC，配置变化时缓存作废
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t reserved;
+    uint32_t ip;            // DHCP 租约(网络字节序，同 IPAddress 的 uint32 值)
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    uint32_t serverIp;      // 0 表示未解析
+    uint32_t crc;           // 以上字段的 CRC
+};
+
+RTC_DATA_ATTR static WiFiFastCache rtcCache;   // 软复位/看门狗复位后保留
+static WiFiFastCache cache;
+static bool cacheValid = false;
+static uint32_t configHash = 0;
+static char serverHost[64];
+static size_t serverHostLen = 0;
+
+enum { ATTEMPT_NONE, ATTEMPT_FAST, ATTEMPT_FULL };
+static uint8_t attempt = ATTEMPT_NONE;
+static unsigned long attemptStart = 0;
+static unsigned long connectStart = 0;         // 本次连接的起点(快速连接回退时包含其耗时)
+static volatile unsigned long gotIpAt = 0;     // WiFi 事件任务写
+static unsigned long lastResolveAt = 0;
+
+// 服务器地址状态：上传任务、长轮询任务(核心0)与主循环(核心1)都会读写，
+// cache.serverIp 与 serverFailStreak 只在 serverMux 内读写，wifiStats.serverIpDrops 只在其中更新
+static portMUX_TYPE serverMux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t serverFailStreak = 0;
+
+static const uint16_t HIST_EDGES_MS[WIFI_HIST_BUCKETS - 1] = {100, 200, 500, 1000, 2000, 5000};
+
+static uint32_t cacheCrc(const WiFiFastCache& c) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&c, offsetof(WiFiFastCache, crc));
+}
+
+static bool cacheUsable(const WiFiFastCache& c) {
+    return c.magic == WIFI_CACHE_MAGIC && c.configHash == configHash && c.crc == cacheCrc(c) && c.channel != 0;
+}
+
+// 从 SERVER_URL 取主机名，与 SSID/密码一起计算配置哈希
+static void parseConfig() {
+    const char* host = strstr(SERVER_URL, "://");
+    host = host ? host + 3 : SERVER_URL;
+    serverHostLen = min(strcspn(host, ":/"), sizeof(serverHost) - 1);
+    memcpy(serverHost, host, serverHostLen);
+    serverHost[serverHostLen] = '\0';
+
+    configHash = esp_rom_crc32_le(0, (const uint8_t*)WIFI_SSID, strlen(WIFI_SSID) + 1);
+    configHash = esp_rom_crc32_le(configHash, (const uint8_t*)WIFI_PASS, strlen(WIFI_PASS) + 1);
+    configHash = esp_rom_crc32_le(configHash, (const uint8_t*)serverHost, serverHostLen);
+}
+
+// 优先取 RTC 内存中的缓存，其次 NVS
+static void loadCache() {
+    cacheValid = false;
+    if (cacheUsable(rtcCache)) {
+        cache = rtcCache;
+        cacheValid = true;
+        return;
+    }
+    Preferences prefs;
+    if (!prefs.begin(WIFI_NVS_NAMESPACE, true)) return;
+    if (prefs.getBytes("cache", &cache, sizeof(cache)) == sizeof(cache) && cacheUsable(cache)) {
+        rtcCache = cache;
+        cacheValid = true;
+    }
+    prefs.end();
+}
+
+static uint32_t serverIpSnapshot() {
+    portENTER_CRITICAL(&serverMux);
+    uint32_t ip = cache.serverIp;
+    portEXIT_CRITICAL(&serverMux);
+    return ip;
+}
+
+// 写回 RTC 内存；NVS 只在内容变化时写，避免每次重连都擦写 flash
+static void saveCache() {
+    // 在锁内取快照，避免网络任务同时清除 serverIp 导致 CRC 与内容不一致
+    portENTER_CRITICAL(&serverMux);
+    cache.magic = WIFI_CACHE_MAGIC;
+    cache.configHash = configHash;
+    cache.crc = cacheCrc(cache);
+    WiFiFastCache snapshot = cache;
+    portEXIT_CRITICAL(&serverMux);
+    rtcCache = snapshot;
+    cacheValid = snapshot.channel != 0;
+
+    Preferences prefs;
+    if (!prefs.begin(WIFI_NVS_NAMESPACE, false)) return;
+    WiFiFastCache stored;
+    if (prefs.getBytes("cache", &stored, sizeof(stored)) != sizeof(stored) || memcmp(&stored, &snapshot, sizeof(snapshot)) != 0) {
+        prefs.putBytes("cache", &snapshot, sizeof(snapshot));
+        wifiStats.nvsWrites++;
+    }
+    prefs.end();
+}
+
+void wifiForgetCache() {
+    portENTER_CRITICAL(&serverMux);
+    memset(&cache, 0, sizeof(cache));
+    portEXIT_CRITICAL(&serverMux);
+    memset(&rtcCache, 0, sizeof(rtcCache));
+    cacheValid = false;
+    Preferences prefs;
+    if (prefs.begin(WIFI_NVS_NAMESPACE, false)) {
+        prefs.clear();
+        prefs.end();
+    }
+}
+
+static void resolveServer() {
+    IPAddress ip;
+    wifiStats.dnsLookups++;
+    lastResolveAt = millis();
+    if (WiFi.hostByName(serverHost, ip) == 1 && (uint32_t)ip != 0) {
+        portENTER_CRITICAL(&serverMux);
+        cache.serverIp = (uint32_t)ip;
+        serverFailStreak = 0;
+        portEXIT_CRITICAL(&serverMux);
+    } else {
+        wifiStats.dnsFailures++;
+    }
+}
+
+// ================= 连接状态机 =================
+
+static void onGotIp(WiFiEvent_t event, WiFiEventInfo_t info) {
+    gotIpAt = millis();
+    wakeMainLoop();
+}
+
+static void recordConnectTime(int path, uint32_t ms) {
+    int b = 0;
+    while (b < WIFI_HIST_BUCKETS - 1 && ms >= HIST_EDGES_MS[b]) b++;
+    wifiStats.hist[path][b]++;
+    wifiStats.successes[path]++;
+    wifiStats.totalMs[path] += ms;
+    if (wifiStats.minMs[path] == 0 || ms < wifiStats.minMs[path]) wifiStats.minMs[path] = ms;
+    if (ms > wifiStats.maxMs[path]) wifiStats.maxMs[path] = ms;
+}
+
+static void beginAttempt(bool fast) {
+    WiFi.disconnect();
+    gotIpAt = 0;
+    if (fast) {
+#if WIFI_REUSE_DHCP_LEASE
+        WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+#else
+        WiFi.config((uint32_t)0, (uint32_t)0, (uint32_t)0);
+#endif
+        WiFi.begin(WIFI_SSID, WIFI_PASS, cache.channel, cache.bssid);
+    } else {
+        // 清除静态配置，恢复 DHCP
+        WiFi.config((uint32_t)0, (uint32_t)0, (uint32_t)0);
         WiFi.begin(WIFI_SSID, WIFI_PASS);
-        int wifiTry = 0;
-        while (WiFi.status() != WL_CONNECTED && wifiTry < 10) {
-            delay(500);
-            Serial.print(".");
-            wifiTry++;
+    }
+    if (attempt == ATTEMPT_NONE) connectStart = millis();
+    attempt = fast ? ATTEMPT_FAST : ATTEMPT_FULL;
+    wifiStats.attempts[fast ? 0 : 1]++;
+    attemptStart = millis();
+}
+
+static void finishAttempt() {
+    bool fast = (attempt == ATTEMPT_FAST);
+    unsigned long end = gotIpAt ? gotIpAt : millis();
+    uint32_t ms = end - connectStart;
+    recordConnectTime(fast ? 0 : 1, ms);
+    attempt = ATTEMPT_NONE;
+
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid != NULL) memcpy(cache.bssid, bssid, 6);
+    cache.channel = (uint8_t)WiFi.channel();
+    cache.ip = (uint32_t)WiFi.localIP();
+    cache.gateway = (uint32_t)WiFi.gatewayIP();
+    cache.subnet = (uint32_t)WiFi.subnetMask();
+    cache.dns = (uint32_t)WiFi.dnsIP();
+    // 全扫描说明网络环境可能变了，顺便刷新服务器地址
+    if (!fast || serverIpSnapshot() == 0) resolveServer();
+    saveCache();
+
+    deviceMac = WiFi.macAddress();
+    uint32_t ip = cache.ip;
+    LOG_I(LOG_MOD_SYS, "[WiFi] 已连接 (%s, %lu ms) IP: %u.%u.%u.%u\n", fast ? "快速" : "全扫描", (unsigned long)ms,
+          ip & 0xFF, (ip >> 8) & 0xFF, (ip >> 16) & 0xFF, ip >> 24);
+}
+
+// 推进连接尝试，返回 true 表示本次尝试已结束(成功或失败)
+static bool serviceAttempt() {
+    if (attempt == ATTEMPT_NONE) return true;
+    wl_status_t status = WiFi.status();
+    if (status == WL_CONNECTED) {
+        finishAttempt();
+        return true;
+    }
+    unsigned long elapsed = millis() - attemptStart;
+    if (attempt == ATTEMPT_FAST) {
+        // 缓存的 AP 不在或拒绝关联时立即回退，不必等到超时
+        if (elapsed > WIFI_FAST_TIMEOUT_MS || status == WL_NO_SSID_AVAIL || status == WL_CONNECT_FAILED) {
+            wifiStats.fallbacks++;
+            cacheValid = false;
+            beginAttempt(false);
         }
-        if (WiFi.status() == WL_CONNECTED) {
-            Serial.println("\n[WiFi] 重新连接成功!");
-            Serial.print("IP: ");
-            Serial.println(WiFi.localIP());
-            deviceMac = WiFi.macAddress();
-        } else {
-            Serial.println("\n[WiFi] 重新连接失败。");
+        return false;
+    }
+    if (elapsed > WIFI_FULL_TIMEOUT_MS) {
+        wifiStats.failures++;
+        attempt = ATTEMPT_NONE;
+        WiFi.disconnect();
+        LOG_W(LOG_MOD_SYS, "[WiFi] 重新连接失败。\n");
+        return true;
+    }
+    return false;
+}
+
+static bool connectBlocking(bool fast) {
+    beginAttempt(fast);
+    while (!serviceAttempt()) delay(WIFI_CONNECT_POLL_MS);
+    logFlush();   // 开机/基准中与直接输出保持顺序
+    return WiFi.status() == WL_CONNECTED;
+}
+
+bool wifiConnecting() {
+    return attempt != ATTEMPT_NONE;
+}
+
+// WiFi连接状态检测与自动重连
+void checkWiFiAndReconnect() {
+    if (attempt != ATTEMPT_NONE) {
+        serviceAttempt();
+        return;
+    }
+    if (WiFi.status() == WL_CONNECTED) {
+        // 服务器地址缓存被丢弃或开机时解析失败：限频重新解析
+        if (serverIpSnapshot() == 0 && millis() - lastResolveAt > WIFI_RESOLVE_RETRY_MS) {
+            resolveServer();
+            if (serverIpSnapshot() != 0) saveCache();
         }
+        return;
     }
+    LOG_W(LOG_MOD_SYS, "[WiFi] 连接丢失，正在尝试重连...\n");
+    beginAttempt(cacheValid);
 }
 
 // 初始化WiFi连接
 bool initWiFi() {
+    parseConfig();
+    loadCache();
     WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID, WIFI_PASS);
-    Serial.print("Connecting to WiFi");
-    int wifiTry = 0;
-    while (WiFi.status() != WL_CONNECTED && wifiTry < 20) {
-        delay(500);
-        Serial.print(".");
-        wifiTry++;
-    }
+    WiFi.persistent(false);         // 连接参数由本模块缓存，不必每次 begin 都写 NVS
+    WiFi.setAutoReconnect(false);   // 重连由 checkWiFiAndReconnect 负责
+    WiFi.onEvent(onGotIp, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    Serial.printf("Connecting to WiFi (%s)\n", cacheValid ? "cached AP" : "full scan");
 
-    bool wifiConnected = (WiFi.status() == WL_CONNECTED);
+    bool wifiConnected = connectBlocking(cacheValid);
     if (wifiConnected) {
-        Serial.println("\nWiFi connected!");
+        Serial.println("WiFi connected!");
         Serial.print("IP: ");
         Serial.println(WiFi.localIP());
-        deviceMac = WiFi.macAddress();
         Serial.print("Device MAC: ");
         Serial.println(deviceMac);
     } else {
-        Serial.println("\nWiFi connect failed, continue serial only.");
+        Serial.println("WiFi connect failed, continue serial only.");
     }
 
     return wifiConnected;
 }
 
+// 记录一次直连缓存地址的结果(上传任务与长轮询任务中调用)
+static void noteDirectConnect(bool ok) {
+    portENTER_CRITICAL(&serverMux);
+    if (ok) {
+        serverFailStreak = 0;
+    } else if (++serverFailStreak >= WIFI_SERVER_FAIL_LIMIT && cache.serverIp != 0) {
+        // 可能是服务器换了地址：丢弃缓存，由主循环重新解析
+        cache.serverIp = 0;
+        wifiStats.serverIpDrops++;
+        serverFailStreak = 0;
+    }
+    portEXIT_CRITICAL(&serverMux);
+}
+
+bool wifiBeginServerRequest(HTTPClient& http, WiFiClient& client, const char* url, uint32_t connectTimeoutMs) {
+    // 只处理 http://<服务器主机>[:端口]/路径，其余交给 HTTPClient 按 URL 解析
+    uint32_t ip = serverIpSnapshot();
+    if (ip == 0 || strncmp(url, "http://", 7) != 0) return http.begin(client, url);
+    const char* host = url + 7;
+    size_t hostLen = strcspn(host, ":/");
+    if (hostLen != serverHostLen || strncmp(host, serverHost, hostLen) != 0) return http.begin(client, url);
+
+    const char* path = host + hostLen;
+    uint16_t port = 80;
+    if (*path == ':') {
+        port = (uint16_t)atoi(path + 1);
+        path += strcspn(path, "/");
+    }
+    if (*path == '\0') path = "/";
+
+    unsigned long connectStart = millis();
+    bool connected = client.connect(IPAddress(ip), port, (int32_t)connectTimeoutMs);
+    noteDirectConnect(connected);
+    if (!connected) {
+        // 缓存的地址连不上：在剩余的建连预算内按主机名重连(连接被拒时预算基本还在)，
+        // 直连已超时则本次放弃，不再额外花一个 connectTimeoutMs；连续失败后丢弃缓存
+        uint32_t spent = millis() - connectStart;
+        if (spent >= connectTimeoutMs) return false;
+        http.setConnectTimeout((int32_t)(connectTimeoutMs - spent));
+        return http.begin(client, url);
+    }
+    // client 已连接，HTTPClient 发请求时复用它而不再解析主机名；Host 头取自这里的 serverHost
+    return http.begin(client, String(serverHost), port, String(path));
+}
+
+
+// ================= 连接耗时对比 =================
+
+void runWiFiBench(uint32_t rounds) {
+    Serial.printf("\n--- WiFi Bench: %lu rounds (fast vs full scan) ---\n", (unsigned long)rounds);
+    portENTER_CRITICAL(&serverMux);
+    memset(&wifiStats, 0, sizeof(wifiStats));
+    portEXIT_CRITICAL(&serverMux);
+    attempt = ATTEMPT_NONE;   // 放弃进行中的重连，由基准重新发起
+    for (uint32_t i = 0; i < rounds; i++) {
+        for (int path = 0; path < 2; path++) {
+            bool fast = (path == 0);
+            if (fast && !cacheValid) continue;
+            WiFi.disconnect();
+            delay(200);
+            if (!connectBlocking(fast)) Serial.printf("  round %lu: %s failed\n", (unsigned long)i, fast ? "fast" : "full");
+        }
+    }
+    Serial.println(getWiFiStatusInfo());
+    Serial.println("--- Done ---\n");
+}
+
 // 获取WiFi连接状态信息
 String getWiFiStatusInfo() {
     String info = "[WiFi] 状态: ";
@@ -69,6 +370,8 @@ String getWiFiStatusInfo() {
         info += WiFi.localIP().toString();
         info += "  MAC: ";
         info += WiFi.macAddress();
+    } else if (attempt != ATTEMPT_NONE) {
+        info += (attempt == ATTEMPT_FAST) ? "快速连接中" : "全扫描连接中";
     } else if (wifiStatus == WL_NO_SSID_AVAIL) {
         info += "找不到SSID";
     } else if (wifiStatus == WL_CONNECT_FAILED) {
@@ -81,5 +384,35 @@ String getWiFiStatusInfo() {
         info += "未知";
     }
 
+    char line[200];
+    uint32_t serverIp = serverIpSnapshot();
+    IPAddress server(serverIp);
+    if (cacheValid) {
+        snprintf(line, sizeof(line), "\n[WiFi] 快速重连缓存: BSSID %02X:%02X:%02X:%02X:%02X:%02X 信道 %u IP %s 服务器 %s",
+                 cache.bssid[0], cache.bssid[1], cache.bssid[2], cache.bssid[3], cache.bssid[4], cache.bssid[5],
+                 cache.channel, IPAddress(cache.ip).toString().c_str(),
+                 serverIp ? server.toString().c_str() : "(未解析)");
+    } else {
+        snprintf(line, sizeof(line), "\n[WiFi] 快速重连缓存: 无 服务器 %s", serverIp ? server.toString().c_str() : "(未解析)");
+    }
+    info += line;
+
+    info += "\n[WiFi] 连接耗时(ms)  成功/尝试  最短   平均   最长  <100 <200 <500  <1s  <2s  <5s >=5s";
+    static const char* const PATH_NAMES[2] = {"快速  ", "全扫描"};
+    for (int p = 0; p < 2; p++) {
+        uint32_t n = wifiStats.successes[p];
+        snprintf(line, sizeof(line), "\n       %s       %4lu/%-4lu %5lu %6lu %6lu",
+                 PATH_NAMES[p], (unsigned long)n, (unsigned long)wifiStats.attempts[p], (unsigned long)wifiStats.minMs[p],
+                 n ? (unsigned long)(wifiStats.totalMs[p] / n) : 0, (unsigned long)wifiStats.maxMs[p]);
+        info += line;
+        for (int b = 0; b < WIFI_HIST_BUCKETS; b++) {
+            snprintf(line, sizeof(line), " %4lu", (unsigned long)wifiStats.hist[p][b]);
+            info += line;
+        }
+    }
+    snprintf(line, sizeof(line), "\n[WiFi] 快速回退=%lu 失败=%lu DNS查询=%lu(失败%lu) 服务器地址失效=%lu NVS写入=%lu",
+             (unsigned long)wifiStats.fallbacks, (unsigned long)wifiStats.failures, (unsigned long)wifiStats.dnsLookups,
+             (unsigned long)wifiStats.dnsFailures, (unsigned long)wifiStats.serverIpDrops, (unsigned long)wifiStats.nvsWrites);
+    info += line;
     return info;
-}
\ No newline at end of file
+}
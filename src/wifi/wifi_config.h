@@ -2,6 +2,7 @@
 #define WIFI_CONFIG_H
 
 #include <WiFi.h>
+#include <HTTPClient.h>
 #include <Arduino.h>
 
 // ================= WiFi 配置 =================
@@ -19,6 +20,51 @@ extern const char* WIFI_PASS;        // WiFi密码
 
 // ================= 服务器配置 =================
 extern const char* SERVER_URL;       // 服务器URL（通常不需要修改）
+extern const char* SERVER_CMD_URL;   // 远程指令长轮询URL
+extern const char* SERVER_HEATMAP_URL; // 占用热力图快照上传URL
+
+// ================= 快速重连 =================
+// 上次成功连接的 AP(BSSID/信道)、DHCP 租约(IP/网关/掩码/DNS)与服务器解析地址缓存在 RTC 内存
+// (软复位后保留)与 NVS(断电后保留，内容变化时才写)。连接时先按缓存的 BSSID + 信道定向关联
+// (跳过全信道扫描)，WIFI_FAST_TIMEOUT_MS 内未连上则回退为全信道扫描 + DHCP。
+// SSID/密码/服务器主机名变化时缓存自动作废。
+// 服务器地址缓存后，wifiBeginServerRequest() 让 WiFiClient 先直连缓存的 IP，HTTPClient 复用该连接，
+// HTTP 请求不再做 DNS 查询；URL 与 Host 头仍是主机名，虚拟主机/反向代理按主机名路由不受影响。
+// 连续 WIFI_SERVER_FAIL_LIMIT 次连不上服务器时丢弃缓存地址，重新解析。
+// 默认定向关联后仍走 DHCP。构建时定义 WIFI_REUSE_DHCP_LEASE=1 可直接使用缓存的 IP 配置(再省去 DHCP)，
+// 但这相当于永久使用静态 IP：租约过期后路由器可能把该地址分给其他设备而发生冲突，
+// 只应在路由器为设备做了 DHCP 保留时开启。
+// 重连不阻塞主循环：checkWiFiAndReconnect() 发起连接后立即返回，之后每次调用推进状态。
+
+#ifndef WIFI_REUSE_DHCP_LEASE
+#define WIFI_REUSE_DHCP_LEASE   0
+#endif
+
+#define WIFI_FAST_TIMEOUT_MS    1500    // 定向关联超时，超时后回退全扫描
+#define WIFI_FULL_TIMEOUT_MS    10000   // 全扫描 + DHCP 超时
+#define WIFI_CONNECT_POLL_MS    20      // 连接进行中的检查间隔
+#define WIFI_BENCH_MAX_ROUNDS   10      // wifi bench 上限(每轮最长约 12s，期间主循环阻塞)
+#define WIFI_RESOLVE_RETRY_MS   30000   // 服务器地址解析失败后的重试间隔
+#define WIFI_SERVER_FAIL_LIMIT  3       // 连续直连失败次数，达到则丢弃缓存的服务器地址
+#define WIFI_HIST_BUCKETS       7       // 连接耗时分布：<100 <200 <500 <1000 <2000 <5000 >=5000 ms
+
+// 连接耗时统计(从发起连接到拿到 IP)，[0] 为定向快速连接，[1] 为全扫描(快速连接回退时计入其耗时)
+struct WiFiConnectStats {
+    uint32_t attempts[2];
+    uint32_t successes[2];
+    uint32_t hist[2][WIFI_HIST_BUCKETS];
+    uint32_t minMs[2];
+    uint32_t maxMs[2];
+    uint64_t totalMs[2];
+    uint32_t fallbacks;         // 快速连接失败回退为全扫描
+    uint32_t failures;          // 全扫描也失败
+    uint32_t dnsLookups;
+    uint32_t dnsFailures;
+    uint32_t serverIpDrops;     // 缓存的服务器地址因连接失败被丢弃
+    uint32_t nvsWrites;
+};
+
+extern WiFiConnectStats wifiStats;
 
 // ================= 全局变量 =================
 extern String deviceMac;                    // 设备MAC地址
@@ -27,13 +73,29 @@ extern unsigned long uploadInterval;        // 上传间隔(毫秒)
 
 // ================= WiFi 相关函数 =================
 
-// WiFi连接状态检测与自动重连
+// WiFi连接状态检测与自动重连(不阻塞，连接进行中时应以 WIFI_CONNECT_POLL_MS 间隔调用)
 void checkWiFiAndReconnect();
 
-// 初始化WiFi连接
+// 是否有连接尝试正在进行
+bool wifiConnecting();
+
+// 初始化WiFi连接(开机时阻塞等待，优先使用缓存快速连接)
 bool initWiFi();
 
-// 获取WiFi连接状态信息
+// 开始一个到服务器的 HTTP 请求(代替 http.begin(client, url))：url 的主机为服务器且已缓存地址时，
+// client 先在 connectTimeoutMs 内直连缓存的 IP，HTTPClient 复用这条连接；未缓存或其他主机时按 URL 正常解析。
+// 直连失败(连续 WIFI_SERVER_FAIL_LIMIT 次后丢弃缓存)时，按主机名重连只用 connectTimeoutMs 的剩余部分
+// (覆盖 http 的建连超时)，预算已用完则返回 false，调用方不应再发请求。Host 头始终是 URL 中的主机名
+bool wifiBeginServerRequest(HTTPClient& http, WiFiClient& client, const char* url, uint32_t connectTimeoutMs);
+
+// 清除快速重连缓存(下次连接走全扫描)
+void wifiForgetCache();
+
+// 连接耗时对比：断开后交替做 rounds 次快速连接与全扫描连接(开始前清零统计)。
+// 在主循环中阻塞执行，期间不读取雷达串口(摄入停顿)，rounds 不超过 WIFI_BENCH_MAX_ROUNDS
+void runWiFiBench(uint32_t rounds);
+
+// 获取WiFi连接状态、快速重连缓存与连接耗时分布
 String getWiFiStatusInfo();
 
 #endif // WIFI_CONFIG_H
\ No newline at end of file
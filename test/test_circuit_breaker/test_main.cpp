@@ -0,0 +1,101 @@
+// 熔断器状态机的主机单元测试：pio test -e native -f test_circuit_breaker
+#include <unity.h>
+#include "../../src/sync/circuit_breaker.h"
+
+void setUp() {}
+void tearDown() {}
+
+// 从 now 开始连续失败直到熔断
+static void tripAt(CircuitBreaker& b, uint32_t now) {
+    for (int i = 0; i < BREAKER_FAILURE_THRESHOLD; i++) b.recordFailure(now);
+}
+
+static void test_stays_closed_below_threshold() {
+    CircuitBreaker b;
+    for (int i = 0; i < BREAKER_FAILURE_THRESHOLD - 1; i++) {
+        TEST_ASSERT_FALSE(b.recordFailure(1000));
+        TEST_ASSERT_TRUE(b.allow(1000));
+    }
+    TEST_ASSERT_EQUAL(BREAKER_CLOSED, b.state());
+    // 成功清零连续失败计数
+    b.recordSuccess();
+    for (int i = 0; i < BREAKER_FAILURE_THRESHOLD - 1; i++) TEST_ASSERT_FALSE(b.recordFailure(1000));
+    TEST_ASSERT_EQUAL(BREAKER_CLOSED, b.state());
+}
+
+static void test_opens_at_threshold_and_rejects_during_backoff() {
+    CircuitBreaker b;
+    for (int i = 0; i < BREAKER_FAILURE_THRESHOLD - 1; i++) b.recordFailure(1000);
+    TEST_ASSERT_TRUE(b.recordFailure(1000));
+    TEST_ASSERT_EQUAL(BREAKER_OPEN, b.state());
+    TEST_ASSERT_EQUAL_UINT32(BREAKER_BASE_BACKOFF_MS, b.backoffMs());
+    TEST_ASSERT_EQUAL_UINT32(BREAKER_BASE_BACKOFF_MS, b.remainingMs(1000));
+    TEST_ASSERT_FALSE(b.allow(1000));
+    TEST_ASSERT_FALSE(b.allow(1000 + BREAKER_BASE_BACKOFF_MS - 1));
+    TEST_ASSERT_EQUAL_UINT32(1, b.remainingMs(1000 + BREAKER_BASE_BACKOFF_MS - 1));
+    TEST_ASSERT_EQUAL(BREAKER_OPEN, b.state());
+}
+
+static void test_half_open_allows_single_probe() {
+    CircuitBreaker b;
+    tripAt(b, 1000);
+    TEST_ASSERT_TRUE(b.allow(1000 + BREAKER_BASE_BACKOFF_MS));
+    TEST_ASSERT_EQUAL(BREAKER_HALF_OPEN, b.state());
+    TEST_ASSERT_EQUAL_UINT32(0, b.remainingMs(1000 + BREAKER_BASE_BACKOFF_MS));
+    // 探测结果出来前不再放行
+    TEST_ASSERT_FALSE(b.allow(1000 + BREAKER_BASE_BACKOFF_MS + 1));
+    TEST_ASSERT_FALSE(b.allow(1000 + 10 * BREAKER_MAX_BACKOFF_MS));
+}
+
+static void test_probe_success_closes() {
+    CircuitBreaker b;
+    tripAt(b, 0);
+    TEST_ASSERT_TRUE(b.allow(BREAKER_BASE_BACKOFF_MS));
+    b.recordSuccess();
+    TEST_ASSERT_EQUAL(BREAKER_CLOSED, b.state());
+    TEST_ASSERT_EQUAL(0, b.consecutiveFailures());
+    TEST_ASSERT_EQUAL_UINT32(0, b.backoffMs());
+    TEST_ASSERT_TRUE(b.allow(BREAKER_BASE_BACKOFF_MS));
+    // 再次熔断从基础退避开始
+    tripAt(b, 5000);
+    TEST_ASSERT_EQUAL_UINT32(BREAKER_BASE_BACKOFF_MS, b.backoffMs());
+}
+
+static void test_probe_failure_doubles_backoff_up_to_cap() {
+    CircuitBreaker b;
+    uint32_t now = 0;
+    tripAt(b, now);
+    uint32_t expected = BREAKER_BASE_BACKOFF_MS;
+    for (int round = 0; round < 10; round++) {
+        TEST_ASSERT_EQUAL_UINT32(expected, b.backoffMs());
+        TEST_ASSERT_FALSE(b.allow(now + expected - 1));
+        now += expected;
+        TEST_ASSERT_TRUE(b.allow(now));
+        TEST_ASSERT_TRUE(b.recordFailure(now));
+        TEST_ASSERT_EQUAL(BREAKER_OPEN, b.state());
+        expected = expected * 2 < BREAKER_MAX_BACKOFF_MS ? expected * 2 : BREAKER_MAX_BACKOFF_MS;
+    }
+    TEST_ASSERT_EQUAL_UINT32(BREAKER_MAX_BACKOFF_MS, b.backoffMs());
+}
+
+// millis() 约 49.7 天回绕：退避按差值计算，跨回绕仍正确
+static void test_backoff_across_millis_wraparound() {
+    CircuitBreaker b;
+    uint32_t start = 0xFFFFFFFFu - 500;
+    tripAt(b, start);
+    TEST_ASSERT_FALSE(b.allow(start + 1000));                        // 已回绕到 499
+    TEST_ASSERT_EQUAL_UINT32(BREAKER_BASE_BACKOFF_MS - 1000, b.remainingMs(start + 1000));
+    TEST_ASSERT_TRUE(b.allow(start + BREAKER_BASE_BACKOFF_MS));
+    TEST_ASSERT_EQUAL(BREAKER_HALF_OPEN, b.state());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stays_closed_below_threshold);
+    RUN_TEST(test_opens_at_threshold_and_rejects_during_backoff);
+    RUN_TEST(test_half_open_allows_single_probe);
+    RUN_TEST(test_probe_success_closes);
+    RUN_TEST(test_probe_failure_doubles_backoff_up_to_cap);
+    RUN_TEST(test_backoff_across_millis_wraparound);
+    return UNITY_END();
+}
@@ -0,0 +1,82 @@
+// 浸泡测试判定的主机单元测试：pio test -e native -f test_heap_soak_check
+#include <unity.h>
+#include "../../src/sys/heap_soak_check.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_frag_pct() {
+    TEST_ASSERT_EQUAL_UINT8(0, heapFragPct(200000, 200000));
+    TEST_ASSERT_EQUAL_UINT8(50, heapFragPct(200000, 100000));
+    TEST_ASSERT_EQUAL_UINT8(99, heapFragPct(200000, 2000));
+    TEST_ASSERT_EQUAL_UINT8(100, heapFragPct(200000, 0));
+    TEST_ASSERT_EQUAL_UINT8(0, heapFragPct(0, 0));
+    // 两次查询之间堆有变化时最大块可能大于空闲，不应回绕成 200+%
+    TEST_ASSERT_EQUAL_UINT8(0, heapFragPct(100000, 120000));
+}
+
+// 在给定采样序列上跑一次判定：前半程 first、后半程 second，每个元素是 {空闲, 最大块}
+static bool runSoak(const uint32_t (*first)[2], int nFirst, const uint32_t (*second)[2], int nSecond,
+                    uint32_t endFree, uint32_t endLargest, HeapSoakCheck& check) {
+    check.begin(200000, 100000);
+    for (int i = 0; i < nFirst; i++) check.sample(false, first[i][0], first[i][1]);
+    for (int i = 0; i < nSecond; i++) check.sample(true, second[i][0], second[i][1]);
+    return check.finish(endFree, endLargest);
+}
+
+static void test_flat_heap_passes() {
+    const uint32_t first[][2] = {{196000, 100000}, {195500, 99000}};
+    const uint32_t second[][2] = {{195800, 100000}, {196000, 99500}};
+    HeapSoakCheck check;
+    TEST_ASSERT_TRUE(runSoak(first, 2, second, 2, 200000, 100000, check));
+    TEST_ASSERT_EQUAL_INT32(0, check.freeDelta);
+    TEST_ASSERT_EQUAL_INT32(4500, check.peakFirst);
+    TEST_ASSERT_EQUAL_INT32(4200, check.peakSecond);
+    TEST_ASSERT_EQUAL_UINT32(99000, check.minLargest);
+}
+
+static void test_small_drift_within_tolerance_passes() {
+    const uint32_t first[][2] = {{196000, 100000}};
+    const uint32_t second[][2] = {{196000 - HEAP_SOAK_TOLERANCE, 100000}};
+    HeapSoakCheck check;
+    TEST_ASSERT_TRUE(runSoak(first, 1, second, 1, 200000 - HEAP_SOAK_TOLERANCE + 1,
+                             100000 - HEAP_SOAK_TOLERANCE + 1, check));
+}
+
+static void test_leak_fails() {
+    const uint32_t first[][2] = {{196000, 100000}};
+    const uint32_t second[][2] = {{195000, 100000}};
+    HeapSoakCheck check;
+    TEST_ASSERT_FALSE(runSoak(first, 1, second, 1, 200000 - 4096, 100000, check));
+    TEST_ASSERT_EQUAL_INT32(-4096, check.freeDelta);
+}
+
+static void test_fragmentation_fails() {
+    const uint32_t first[][2] = {{196000, 90000}};
+    const uint32_t second[][2] = {{196000, 60000}};
+    HeapSoakCheck check;
+    TEST_ASSERT_FALSE(runSoak(first, 1, second, 1, 200000, 60000, check));
+    TEST_ASSERT_EQUAL_INT32(-40000, check.largestDelta);
+    TEST_ASSERT_EQUAL_UINT32(60000, check.minLargest);
+}
+
+// 结束时已释放，但后半程峰值持续升高(缓存/队列无上限增长)
+static void test_growing_peak_fails() {
+    const uint32_t first[][2] = {{196000, 100000}};
+    const uint32_t second[][2] = {{190000, 100000}};
+    HeapSoakCheck check;
+    TEST_ASSERT_FALSE(runSoak(first, 1, second, 1, 200000, 100000, check));
+    TEST_ASSERT_EQUAL_INT32(4000, check.peakFirst);
+    TEST_ASSERT_EQUAL_INT32(10000, check.peakSecond);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_frag_pct);
+    RUN_TEST(test_flat_heap_passes);
+    RUN_TEST(test_small_drift_within_tolerance_passes);
+    RUN_TEST(test_leak_fails);
+    RUN_TEST(test_fragmentation_fails);
+    RUN_TEST(test_growing_peak_fails);
+    return UNITY_END();
+}
@@ -0,0 +1,182 @@
+// LD2450 协议描述表与编码/解码的主机单元测试：pio test -e native -f test_ld2450_protocol
+#include <unity.h>
+#include <string.h>
+#include "../../src/radar/ld2450_protocol.h"
+
+using namespace ld2450;
+
+// ACK 输出在设备端实现(依赖 Arduino 与日志)，主机测试只需链接
+namespace ld2450 {
+void Empty::print() const {}
+void Word::print() const {}
+void ConfigAck::print() const {}
+void TrackingMode::print() const {}
+void FirmwareVersion::print() const {}
+void MacAddress::print() const {}
+void ZoneConfig::print() const {}
+template <> void printAck<EnableConfig>(const uint8_t*) {}
+template <> void printAck<EndConfig>(const uint8_t*) {}
+template <> void printAck<SetBluetooth>(const uint8_t*) {}
+}
+
+void setUp() {}
+void tearDown() {}
+
+// 按描述表构造一帧 ACK，返回帧长
+static uint16_t buildAck(const CommandDesc& d, uint16_t status, const uint8_t* data, uint16_t dataLen, uint8_t* out) {
+    uint8_t body[4 + MAX_ACK_FRAME];
+    putU16(body, d.opcode | ACK_FLAG);
+    putU16(body + 2, status);
+    memcpy(body + 4, data, dataLen);
+    // 帧内的"命令字"位置放回显命令字，状态与数据作为命令值
+    return encodeFrame(getU16(body), body + 2, 2 + dataLen, out);
+}
+
+// 通用帧：对描述表中的每条指令检查请求帧与各类 ACK 帧
+static void test_command_frames() {
+    for (size_t c = 0; c < COMMAND_COUNT; c++) {
+        const CommandDesc& d = COMMAND_TABLE[c];
+        uint8_t value[MAX_REQUEST_FRAME];
+        uint8_t frame[MAX_ACK_FRAME + 8];
+        for (uint16_t i = 0; i < d.requestLen; i++) value[i] = (uint8_t)(d.opcode + i * 37);
+
+        uint16_t len = encodeFrame(d.opcode, value, d.requestLen, frame);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(FRAME_OVERHEAD + 2 + d.requestLen, len, d.name);
+        TEST_ASSERT_TRUE_MESSAGE(len <= MAX_REQUEST_FRAME, d.name);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(FRAME_HEAD, frame, 4, d.name);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(FRAME_TAIL, frame + len - 4, 4, d.name);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(2 + d.requestLen, getU16(frame + 4), d.name);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(d.opcode, getU16(frame + 6), d.name);
+        if (d.requestLen > 0) TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(value, frame + 8, d.requestLen, d.name);
+
+        uint8_t ackData[MAX_ACK_FRAME];
+        for (uint16_t i = 0; i < d.ackLen; i++) ackData[i] = (uint8_t)(0xA5 ^ (i * 13));
+        const uint8_t* data = NULL;
+        uint16_t status = 0xFFFF;
+
+        len = buildAck(d, 0, ackData, d.ackLen, frame);
+        TEST_ASSERT_TRUE_MESSAGE(len <= MAX_ACK_FRAME, d.name);
+        TEST_ASSERT_EQUAL_MESSAGE(ACK_OK, checkAck(d, frame, len, &data, &status), d.name);
+        TEST_ASSERT_EQUAL_UINT16(0, status);
+        TEST_ASSERT_EQUAL_PTR(frame + 10, data);
+        if (d.ackLen > 0) TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(ackData, data, d.ackLen, d.name);
+
+        len = buildAck(d, 0x0001, ackData, d.ackLen, frame);
+        TEST_ASSERT_EQUAL_MESSAGE(ACK_STATUS_ERROR, checkAck(d, frame, len, &data, &status), d.name);
+        TEST_ASSERT_EQUAL_UINT16(0x0001, status);
+
+        CommandDesc other = d;
+        other.opcode = d.opcode ^ 0x0001;
+        len = buildAck(other, 0, ackData, d.ackLen, frame);
+        TEST_ASSERT_EQUAL_MESSAGE(ACK_WRONG_CMD, checkAck(d, frame, len, &data, &status), d.name);
+
+        if (d.ackLen > 0) {
+            len = buildAck(d, 0, ackData, d.ackLen - 1, frame);
+            TEST_ASSERT_EQUAL_MESSAGE(ACK_BAD_LENGTH, checkAck(d, frame, len, &data, &status), d.name);
+        }
+
+        len = buildAck(d, 0, ackData, d.ackLen, frame);
+        frame[len - 1] ^= 0xFF;
+        TEST_ASSERT_EQUAL_MESSAGE(ACK_BAD_FRAME, checkAck(d, frame, len, &data, &status), d.name);
+        frame[len - 1] ^= 0xFF;
+        frame[4]++;
+        TEST_ASSERT_EQUAL_MESSAGE(ACK_BAD_FRAME, checkAck(d, frame, len, &data, &status), d.name);
+    }
+}
+
+// 已知报文(协议文档示例)
+static void test_known_vectors() {
+    static const uint8_t ENABLE[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xFF, 0x00, 0x01, 0x00, 0x04, 0x03, 0x02, 0x01};
+    static const uint8_t BAUD[]   = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xA1, 0x00, 0x07, 0x00, 0x04, 0x03, 0x02, 0x01};
+    static const uint8_t REBOOT[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, 0xA3, 0x00, 0x04, 0x03, 0x02, 0x01};
+    static const uint8_t VER_ACK[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x0C, 0x00, 0xA0, 0x01, 0x00, 0x00,
+                                      0x00, 0x01, 0x07, 0x01, 0x16, 0x15, 0x09, 0x22, 0x04, 0x03, 0x02, 0x01};
+    uint8_t frame[MAX_REQUEST_FRAME];
+
+    TEST_ASSERT_EQUAL_UINT16(sizeof(ENABLE), encodeRequest<EnableConfig>(Fixed<1>(), frame));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ENABLE, frame, sizeof(ENABLE));
+    Word baud = {BAUD_256000};
+    TEST_ASSERT_EQUAL_UINT16(sizeof(BAUD), encodeRequest<SetBaudRate>(baud, frame));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(BAUD, frame, sizeof(BAUD));
+    TEST_ASSERT_EQUAL_UINT16(sizeof(REBOOT), encodeRequest<Reboot>(Empty(), frame));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(REBOOT, frame, sizeof(REBOOT));
+
+    const uint8_t* data = NULL;
+    uint16_t status;
+    FirmwareVersion v;
+    TEST_ASSERT_EQUAL(ACK_OK, checkAck(descOf<QueryVersion>(), VER_ACK, sizeof(VER_ACK), &data, &status));
+    TEST_ASSERT_TRUE(decodeAck<QueryVersion>(data, v));
+    TEST_ASSERT_EQUAL_HEX16(0x0107, v.major);
+    TEST_ASSERT_EQUAL_HEX32(0x22091516, v.minor);
+}
+
+// 16 位字段逐值穷举往返
+static void test_word_layouts_exhaustive() {
+    uint8_t buf[MAX_ACK_FRAME];
+    for (uint32_t v = 0; v <= 0xFFFF; v++) {
+        Word w = {(uint16_t)v}, w2;
+        w.encode(buf);
+        TEST_ASSERT_TRUE(w2.decode(buf));
+        TEST_ASSERT_EQUAL_UINT16(v, w2.value);
+
+        TrackingMode m = {(uint16_t)v}, m2;
+        m.encode(buf);
+        TEST_ASSERT_EQUAL(v == MODE_SINGLE || v == MODE_MULTI, m2.decode(buf));
+        TEST_ASSERT_EQUAL_UINT16(v, m2.mode);
+
+        ZoneConfig z, z2;
+        memset(&z, 0, sizeof(z));
+        z.type = (uint16_t)v;
+        z.encode(buf);
+        TEST_ASSERT_EQUAL(v <= ZONE_FILTER, z2.decode(buf));
+        TEST_ASSERT_EQUAL_UINT16(v, z2.type);
+    }
+}
+
+// 区域坐标：每个字段依次取遍全部 int16，其余字段按位取反以检查串位
+static void test_zone_fields_exhaustive() {
+    uint8_t buf[ZoneConfig::SIZE];
+    ZoneConfig z, z2;
+    memset(&z, 0, sizeof(z));
+    z.type = ZONE_FILTER;
+    int16_t* fields = &z.zones[0].x1;
+    for (int f = 0; f < LD2450_ZONE_COUNT * 4; f++) {
+        for (uint32_t v = 0; v <= 0xFFFF; v++) {
+            for (int k = 0; k < LD2450_ZONE_COUNT * 4; k++) fields[k] = (int16_t)(k == f ? v : ~v);
+            z.encode(buf);
+            TEST_ASSERT_TRUE(z2.decode(buf));
+            TEST_ASSERT_EQUAL_MEMORY(&z, &z2, sizeof(z));
+        }
+    }
+}
+
+static void test_fixed_layouts() {
+    uint8_t buf[MAX_ACK_FRAME];
+    FirmwareVersion fv = {0x0100, 0x0107, 0xFEDCBA98}, fv2;
+    fv.encode(buf);
+    TEST_ASSERT_TRUE(fv2.decode(buf));
+    TEST_ASSERT_EQUAL_HEX16(fv.type, fv2.type);
+    TEST_ASSERT_EQUAL_HEX16(fv.major, fv2.major);
+    TEST_ASSERT_EQUAL_HEX32(fv.minor, fv2.minor);
+
+    MacAddress mac = {{0x8F, 0x27, 0x2E, 0xB8, 0x0F, 0x65}}, mac2;
+    mac.encode(buf);
+    TEST_ASSERT_TRUE(mac2.decode(buf));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(mac.mac, mac2.mac, 6);
+
+    ConfigAck c = {0x0001, 0x0040}, c2;
+    c.encode(buf);
+    TEST_ASSERT_TRUE(c2.decode(buf));
+    TEST_ASSERT_EQUAL_UINT16(1, c2.protocolVersion);
+    TEST_ASSERT_EQUAL_UINT16(0x40, c2.bufferSize);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_command_frames);
+    RUN_TEST(test_known_vectors);
+    RUN_TEST(test_word_layouts_exhaustive);
+    RUN_TEST(test_zone_fields_exhaustive);
+    RUN_TEST(test_fixed_layouts);
+    return UNITY_END();
+}
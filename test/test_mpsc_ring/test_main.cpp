@@ -0,0 +1,138 @@
+// 日志环形缓冲区所用无锁队列的主机单元测试：pio test -e native -f test_mpsc_ring
+#include <unity.h>
+#include <thread>
+#include <vector>
+#include "../../src/log/mpsc_ring.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Item {
+    uint32_t producer;
+    uint32_t value;
+};
+
+static bool push(MpscRing<Item, 8>& ring, uint32_t producer, uint32_t value) {
+    uint32_t pos;
+    Item* it = ring.reserve(pos);
+    if (it == NULL) return false;
+    it->producer = producer;
+    it->value = value;
+    ring.commit(pos);
+    return true;
+}
+
+static void test_fifo_and_full() {
+    static MpscRing<Item, 8> ring;
+    ring.reset();
+    TEST_ASSERT_NULL(ring.front());
+    for (uint32_t i = 0; i < 8; i++) TEST_ASSERT_TRUE(push(ring, 0, i));
+    TEST_ASSERT_FALSE(push(ring, 0, 99));          // 满时不阻塞，直接失败
+    TEST_ASSERT_EQUAL_UINT32(8, ring.used());
+    for (uint32_t i = 0; i < 8; i++) {
+        Item* it = ring.front();
+        TEST_ASSERT_NOT_NULL(it);
+        TEST_ASSERT_EQUAL_UINT32(i, it->value);
+        ring.pop();
+    }
+    TEST_ASSERT_NULL(ring.front());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.used());
+}
+
+// 序号远超槽数(反复绕环)后仍保持先进先出
+static void test_wraps_many_times() {
+    static MpscRing<Item, 8> ring;
+    ring.reset();
+    uint32_t next = 0, expect = 0;
+    for (int round = 0; round < 100000; round++) {
+        int n = 1 + round % 8;
+        for (int i = 0; i < n; i++) TEST_ASSERT_TRUE(push(ring, 0, next++));
+        for (int i = 0; i < n; i++) {
+            Item* it = ring.front();
+            TEST_ASSERT_NOT_NULL(it);
+            TEST_ASSERT_EQUAL_UINT32(expect++, it->value);
+            ring.pop();
+        }
+    }
+}
+
+// 先申请的槽未提交时，消费者不会越过它读取后面已提交的槽
+static void test_uncommitted_slot_blocks_consumer() {
+    static MpscRing<Item, 8> ring;
+    ring.reset();
+    uint32_t posA, posB;
+    Item* a = ring.reserve(posA);
+    Item* b = ring.reserve(posB);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    b->value = 2;
+    ring.commit(posB);
+    TEST_ASSERT_NULL(ring.front());
+    TEST_ASSERT_EQUAL_UINT32(2, ring.used());
+    a->value = 1;
+    ring.commit(posA);
+    TEST_ASSERT_EQUAL_UINT32(1, ring.front()->value);
+    ring.pop();
+    TEST_ASSERT_EQUAL_UINT32(2, ring.front()->value);
+    ring.pop();
+    TEST_ASSERT_NULL(ring.front());
+}
+
+// 多个生产者线程与一个消费者并发：每条成功写入的记录恰好读出一次，且每个生产者内部保持顺序
+static void test_concurrent_producers() {
+    const int PRODUCERS = 4;
+    const uint32_t PER_PRODUCER = 200000;
+    static MpscRing<Item, 128> ring;
+    ring.reset();
+    std::vector<uint32_t> pushed(PRODUCERS, 0);
+    std::atomic<int> running(PRODUCERS);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCERS; p++) {
+        threads.emplace_back([&, p] {
+            for (uint32_t i = 0; i < PER_PRODUCER; i++) {
+                uint32_t pos;
+                Item* it = ring.reserve(pos);
+                if (it == NULL) continue;          // 满：与日志一样丢弃
+                it->producer = p;
+                it->value = pushed[p]++;
+                ring.commit(pos);
+            }
+            running.fetch_sub(1);
+        });
+    }
+
+    std::vector<uint32_t> nextExpected(PRODUCERS, 0);
+    uint32_t consumed = 0;
+    bool ordered = true;
+    for (;;) {
+        bool done = running.load() == 0;
+        Item* it;
+        while ((it = ring.front()) != NULL) {
+            if (it->producer >= (uint32_t)PRODUCERS || it->value != nextExpected[it->producer]) ordered = false;
+            else nextExpected[it->producer]++;
+            ring.pop();
+            consumed++;
+        }
+        if (done) break;
+    }
+    for (std::thread& t : threads) t.join();
+
+    TEST_ASSERT_TRUE(ordered);
+    uint32_t total = 0;
+    for (int p = 0; p < PRODUCERS; p++) {
+        TEST_ASSERT_EQUAL_UINT32(pushed[p], nextExpected[p]);
+        total += pushed[p];
+    }
+    TEST_ASSERT_EQUAL_UINT32(total, consumed);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, total);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_and_full);
+    RUN_TEST(test_wraps_many_times);
+    RUN_TEST(test_uncommitted_slot_blocks_consumer);
+    RUN_TEST(test_concurrent_producers);
+    return UNITY_END();
+}
@@ -0,0 +1,145 @@
+// 二进制流记录编码(COBS + CRC16)的主机单元测试：pio test -e native -f test_record_codec
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "../../src/stream/record_codec.h"
+
+void setUp() {}
+void tearDown() {}
+
+// 参考 COBS 解码(与 tools/binary_stream_decoder.py 相同的规则)，格式错误返回 false
+static bool cobsDecode(const uint8_t* in, size_t len, std::vector<uint8_t>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0) return false;
+        for (uint8_t k = 1; k < code; k++) {
+            if (i >= len || in[i] == 0) return false;
+            out.push_back(in[i++]);
+        }
+        if (code != 0xFF && i < len) out.push_back(0);
+    }
+    return true;
+}
+
+static uint32_t rng = 1;
+static uint8_t nextByte() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 24;
+}
+
+static void checkRoundTrip(const std::vector<uint8_t>& in) {
+    std::vector<uint8_t> enc(in.size() + in.size() / 254 + 2);
+    size_t n = cobsEncode(in.data(), in.size(), enc.data());
+    TEST_ASSERT_LESS_OR_EQUAL(in.size() + in.size() / 254 + 1, n);
+    TEST_ASSERT_TRUE(memchr(enc.data(), 0, n) == NULL);
+    std::vector<uint8_t> dec;
+    TEST_ASSERT_TRUE(cobsDecode(enc.data(), n, dec));
+    TEST_ASSERT_EQUAL(in.size(), dec.size());
+    if (!in.empty()) TEST_ASSERT_EQUAL_MEMORY(in.data(), dec.data(), in.size());
+}
+
+// 分组边界：0、1、253、254、255 个非零字节前后夹 0x00
+static void test_cobs_group_boundaries() {
+    const size_t lens[] = {0, 1, 2, 253, 254, 255, 508, 509, 600};
+    for (size_t len : lens) {
+        std::vector<uint8_t> in(len, 0x11);
+        checkRoundTrip(in);
+        in.insert(in.begin(), 0);
+        checkRoundTrip(in);
+        in.push_back(0);
+        checkRoundTrip(in);
+    }
+    checkRoundTrip(std::vector<uint8_t>(300, 0));
+}
+
+static void test_cobs_known_vectors() {
+    const uint8_t in1[] = {0x00};
+    const uint8_t out1[] = {0x01, 0x01};
+    const uint8_t in2[] = {0x11, 0x22, 0x00, 0x33};
+    const uint8_t out2[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+    uint8_t enc[8];
+    TEST_ASSERT_EQUAL(sizeof(out1), cobsEncode(in1, sizeof(in1), enc));
+    TEST_ASSERT_EQUAL_MEMORY(out1, enc, sizeof(out1));
+    TEST_ASSERT_EQUAL(sizeof(out2), cobsEncode(in2, sizeof(in2), enc));
+    TEST_ASSERT_EQUAL_MEMORY(out2, enc, sizeof(out2));
+}
+
+static void test_cobs_random_round_trip() {
+    for (int round = 0; round < 2000; round++) {
+        std::vector<uint8_t> in(nextByte() * 3);
+        // 一半的轮次偏向 0x00，覆盖连续零字节
+        for (uint8_t& b : in) b = (round & 1) && (nextByte() & 3) == 0 ? 0 : nextByte();
+        checkRoundTrip(in);
+    }
+}
+
+// CRC-16/CCITT-FALSE 校验值
+static void test_crc16_check_value() {
+    const char* s = "123456789";
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16Ccitt((const uint8_t*)s, 9));
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, crc16Ccitt(NULL, 0));
+}
+
+static void checkRecord(uint32_t seq, uint32_t ts, uint8_t sensorId, const Target* targets, uint8_t count) {
+    uint8_t out[BIN_MAX_ENCODED_LEN];
+    size_t n = encodeFrameRecord(seq, ts, sensorId, targets, count, out);
+    TEST_ASSERT_LESS_OR_EQUAL(BIN_MAX_ENCODED_LEN, n);
+    TEST_ASSERT_EQUAL_UINT8(0, out[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, out[n - 1]);
+
+    std::vector<uint8_t> rec;
+    TEST_ASSERT_TRUE(cobsDecode(out + 1, n - 2, rec));
+    uint8_t kept = count > BIN_MAX_TARGETS ? BIN_MAX_TARGETS : count;
+    TEST_ASSERT_EQUAL(11 + kept * 8 + 2, rec.size());
+    uint16_t crc = rec[rec.size() - 2] | (rec[rec.size() - 1] << 8);
+    TEST_ASSERT_EQUAL_HEX16(crc16Ccitt(rec.data(), rec.size() - 2), crc);
+
+    const uint8_t* p = rec.data();
+    TEST_ASSERT_EQUAL_UINT8(BIN_RECORD_FRAME, p[0]);
+    TEST_ASSERT_EQUAL_UINT32(seq, p[1] | (p[2] << 8) | (p[3] << 16) | ((uint32_t)p[4] << 24));
+    TEST_ASSERT_EQUAL_UINT32(ts, p[5] | (p[6] << 8) | (p[7] << 16) | ((uint32_t)p[8] << 24));
+    TEST_ASSERT_EQUAL_UINT8(sensorId, p[9]);
+    TEST_ASSERT_EQUAL_UINT8(kept, p[10]);
+    for (int i = 0; i < kept; i++) {
+        const uint8_t* t = p + 11 + i * 8;
+        TEST_ASSERT_EQUAL_INT16(targets[i].x, (int16_t)(t[0] | (t[1] << 8)));
+        TEST_ASSERT_EQUAL_INT16(targets[i].y, (int16_t)(t[2] | (t[3] << 8)));
+        TEST_ASSERT_EQUAL_INT16(targets[i].speed, (int16_t)(t[4] | (t[5] << 8)));
+        TEST_ASSERT_EQUAL_INT16(targets[i].resolution, (int16_t)(t[6] | (t[7] << 8)));
+    }
+}
+
+static void test_frame_record_fields() {
+    Target t[BIN_MAX_TARGETS + 1] = {{-272, 850, -16, 360}, {0, 0, 0, 0}, {32767, -32768, 255, 0}, {1, 2, 3, 4}};
+    checkRecord(0, 0, 0, t, 0);
+    checkRecord(1, 1000, 2, t, 1);
+    checkRecord(0xFFFFFFFFu, 0x00FF00FFu, 1, t, BIN_MAX_TARGETS);
+    // 超出的目标被截断
+    checkRecord(7, 7, 0, t, BIN_MAX_TARGETS + 1);
+}
+
+static void test_frame_record_random() {
+    Target t[BIN_MAX_TARGETS];
+    for (int round = 0; round < 5000; round++) {
+        for (Target& x : t) {
+            x.x = (int16_t)(nextByte() | (nextByte() << 8));
+            x.y = (int16_t)(nextByte() | (nextByte() << 8));
+            x.speed = (nextByte() & 1) ? 0 : (int16_t)(nextByte() << 8);
+            x.resolution = (int16_t)nextByte();
+        }
+        checkRecord(round * 2654435761u, round, nextByte() % 3, t, nextByte() % (BIN_MAX_TARGETS + 1));
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_cobs_group_boundaries);
+    RUN_TEST(test_cobs_known_vectors);
+    RUN_TEST(test_cobs_random_round_trip);
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_frame_record_fields);
+    RUN_TEST(test_frame_record_random);
+    return UNITY_END();
+}
@@ -0,0 +1,141 @@
+// 编译期阶段组合的主机单元测试：pio test -e native -f test_stage_pipeline
+#include <unity.h>
+#include <string>
+#include "../../src/pipeline/stage_pipeline.h"
+
+void setUp() {}
+void tearDown() {}
+
+// 测试用上下文：记录阶段调用顺序
+struct TestFrame {
+    int value;
+    std::string trace;
+};
+
+struct TestPass {
+    std::string trace;
+};
+
+struct AddStage : PipelineStage {
+    static constexpr const char* NAME = "add";
+    int amount = 1;
+    bool onFrame(TestFrame& f) {
+        f.value += amount;
+        f.trace += "A";
+        return true;
+    }
+};
+
+// 丢弃负值帧
+struct DropNegativeStage : PipelineStage {
+    static constexpr const char* NAME = "drop-negative";
+    int dropped = 0;
+    bool onFrame(TestFrame& f) {
+        f.trace += "D";
+        if (f.value < 0) {
+            dropped++;
+            return false;
+        }
+        return true;
+    }
+};
+
+struct SinkStage : PipelineStage {
+    static constexpr const char* NAME = "sink";
+    int frames = 0;
+    int passes = 0;
+    int lastValue = 0;
+    bool onFrame(TestFrame& f) {
+        f.trace += "S";
+        frames++;
+        lastValue = f.value;
+        return true;
+    }
+    void onPass(TestPass& p) {
+        p.trace += "s";
+        passes++;
+    }
+};
+
+// 只有 onPass 的阶段，onFrame 使用默认实现
+struct PassOnlyStage : PipelineStage {
+    static constexpr const char* NAME = "pass-only";
+    void onPass(TestPass& p) { p.trace += "p"; }
+};
+
+static void test_stages_run_in_declaration_order() {
+    StagePipeline<AddStage, DropNegativeStage, PassOnlyStage, SinkStage> pipeline;
+    TestFrame f = {5, ""};
+    TEST_ASSERT_TRUE(pipeline.processFrame(f));
+    TEST_ASSERT_EQUAL_STRING("ADS", f.trace.c_str());
+    TEST_ASSERT_EQUAL(6, f.value);
+    TEST_ASSERT_EQUAL(1, pipeline.stage<3>().frames);
+    TEST_ASSERT_EQUAL(6, pipeline.stage<3>().lastValue);
+
+    TestPass p;
+    pipeline.endPass(p);
+    TEST_ASSERT_EQUAL_STRING("ps", p.trace.c_str());
+    TEST_ASSERT_EQUAL(1, pipeline.stage<3>().passes);
+}
+
+static void test_rejected_frame_skips_later_stages() {
+    StagePipeline<AddStage, DropNegativeStage, SinkStage> pipeline;
+    TestFrame f = {-10, ""};
+    TEST_ASSERT_FALSE(pipeline.processFrame(f));
+    TEST_ASSERT_EQUAL_STRING("AD", f.trace.c_str());
+    TEST_ASSERT_EQUAL(1, pipeline.stage<1>().dropped);
+    TEST_ASSERT_EQUAL(0, pipeline.stage<2>().frames);
+
+    // 丢弃的帧不影响 onPass
+    TestPass p;
+    pipeline.endPass(p);
+    TEST_ASSERT_EQUAL_STRING("s", p.trace.c_str());
+}
+
+static void test_disabled_stage_is_removed() {
+    StagePipeline<StageIf<false, AddStage>, StageIf<true, DropNegativeStage>, SinkStage> pipeline;
+    TEST_ASSERT_EQUAL(3, pipeline.STAGE_COUNT);
+    TEST_ASSERT_NULL(pipeline.stageName(0));
+    TEST_ASSERT_EQUAL_STRING("drop-negative", pipeline.stageName(1));
+    TEST_ASSERT_EQUAL_STRING("sink", pipeline.stageName(2));
+    TEST_ASSERT_NULL(pipeline.stageName(3));
+    static_assert(std::is_same<StageIf<false, AddStage>, NoStage>::value, "disabled stage must be NoStage");
+    static_assert(std::is_same<StageIf<true, AddStage>, AddStage>::value, "enabled stage must be kept");
+
+    TestFrame f = {5, ""};
+    TEST_ASSERT_TRUE(pipeline.processFrame(f));
+    TEST_ASSERT_EQUAL_STRING("DS", f.trace.c_str());
+    TEST_ASSERT_EQUAL(5, f.value);
+}
+
+// 阶段实例保存在流水线中，运行时参数与状态跨帧保留
+static void test_stage_state_persists() {
+    StagePipeline<AddStage, SinkStage> pipeline;
+    pipeline.stage<0>().amount = 10;
+    for (int i = 0; i < 3; i++) {
+        TestFrame f = {i, ""};
+        TEST_ASSERT_TRUE(pipeline.processFrame(f));
+    }
+    TEST_ASSERT_EQUAL(3, pipeline.stage<1>().frames);
+    TEST_ASSERT_EQUAL(12, pipeline.stage<1>().lastValue);
+}
+
+static void test_empty_pipeline_accepts_everything() {
+    StagePipeline<> pipeline;
+    TestFrame f = {1, ""};
+    TEST_ASSERT_TRUE(pipeline.processFrame(f));
+    TestPass p;
+    pipeline.endPass(p);
+    TEST_ASSERT_EQUAL_STRING("", p.trace.c_str());
+    TEST_ASSERT_EQUAL(0, pipeline.STAGE_COUNT);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stages_run_in_declaration_order);
+    RUN_TEST(test_rejected_frame_skips_later_stages);
+    RUN_TEST(test_disabled_stage_is_removed);
+    RUN_TEST(test_stage_state_persists);
+    RUN_TEST(test_empty_pipeline_accepts_everything);
+    return UNITY_END();
+}
@@ -0,0 +1,130 @@
+// 轨迹压缩误差上界的主机单元测试：pio test -e native -f test_track_compressor
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "../../src/analytics/track_compressor.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Sample {
+    uint32_t ts;
+    int16_t x;
+    int16_t y;
+};
+
+static uint32_t rng;
+static uint32_t nextRand() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+// 10Hz 采样的行走轨迹(直行、转向、驻留，叠加 ±noise mm 测量噪声)，与设备端 traj replay 相同
+static std::vector<Sample> walk(uint32_t seed, uint32_t count, int noise) {
+    std::vector<Sample> out(count);
+    rng = seed;
+    float px = 0, py = 2000, heading = 0, speed = 800;   // mm, rad, mm/s
+    uint32_t ts = 0;
+    int legLeft = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (legLeft-- <= 0) {
+            legLeft = 10 + nextRand() % 40;
+            heading = (nextRand() % 6283) / 1000.0f;
+            speed = (nextRand() % 5 == 0) ? 0 : 300 + nextRand() % 1100;
+        }
+        uint32_t dt = 95 + nextRand() % 11;
+        ts += dt;
+        px += speed * cosf(heading) * dt / 1000.0f;
+        py += speed * sinf(heading) * dt / 1000.0f;
+        if (px < -3000 || px > 3000) { heading = 3.14159265f - heading; px = fmaxf(-3000, fminf(px, 3000)); }
+        if (py < 300 || py > 6000) { heading = -heading; py = fmaxf(300, fminf(py, 6000)); }
+        out[i].ts = ts;
+        out[i].x = (int16_t)(lroundf(px) + (int)(nextRand() % (2 * noise + 1)) - noise);
+        out[i].y = (int16_t)(lroundf(py) + (int)(nextRand() % (2 * noise + 1)) - noise);
+    }
+    return out;
+}
+
+static std::vector<TrajPoint> compress(const std::vector<Sample>& in, float tolMm) {
+    std::vector<TrajPoint> keys;
+    TrackCompressor tc;
+    TrajPoint p;
+    for (const Sample& s : in) {
+        if (tc.add(s.ts, s.x, s.y, tolMm, p)) keys.push_back(p);
+    }
+    if (tc.finish(p)) keys.push_back(p);
+    return keys;
+}
+
+// 每个原始点在其所在关键点区间内线性插值，返回最大欧氏误差
+static float maxReconstructionError(const std::vector<Sample>& in, const std::vector<TrajPoint>& keys) {
+    float maxErr = 0;
+    size_t k = 0;
+    for (const Sample& s : in) {
+        while (k + 1 < keys.size() && keys[k + 1].ts < s.ts) k++;
+        const TrajPoint& a = keys[k];
+        const TrajPoint& b = keys[(k + 1 < keys.size()) ? k + 1 : k];
+        float f = (b.ts > a.ts) ? (float)(s.ts - a.ts) / (b.ts - a.ts) : 0;
+        float rx = a.x + (b.x - a.x) * f;
+        float ry = a.y + (b.y - a.y) * f;
+        float err = sqrtf((rx - s.x) * (rx - s.x) + (ry - s.y) * (ry - s.y));
+        if (err > maxErr) maxErr = err;
+    }
+    return maxErr;
+}
+
+static void checkBound(float tolMm, int noise) {
+    for (uint32_t seed = 1; seed <= 8; seed++) {
+        std::vector<Sample> in = walk(seed * 7919, 20000, noise);
+        std::vector<TrajPoint> keys = compress(in, tolMm);
+        TEST_ASSERT_TRUE(keys.size() >= 2);
+        TEST_ASSERT_EQUAL_UINT32(in.front().ts, keys.front().ts);
+        TEST_ASSERT_EQUAL_UINT32(in.back().ts, keys.back().ts);
+        TEST_ASSERT_EQUAL_UINT8(1, keys.back().end);
+        TEST_ASSERT_LESS_OR_EQUAL(tolMm, maxReconstructionError(in, keys));
+        // 关键点时间严格递增，服务器可直接按相邻点插值
+        for (size_t i = 1; i < keys.size(); i++) TEST_ASSERT_TRUE(keys[i].ts > keys[i - 1].ts);
+    }
+}
+
+static void test_error_bound_min_tolerance() { checkBound(10, 20); }
+static void test_error_bound_default_tolerance() { checkBound(100, 20); }
+static void test_error_bound_large_tolerance() { checkBound(1000, 20); }
+static void test_error_bound_noisy() { checkBound(50, 200); }
+
+// 直线匀速运动只保留首尾
+static void test_straight_line_keeps_endpoints() {
+    std::vector<Sample> in;
+    for (uint32_t i = 0; i < 100; i++) in.push_back({i * 100, (int16_t)(i * 10), (int16_t)(1000 + i * 5)});
+    std::vector<TrajPoint> keys = compress(in, 10);
+    TEST_ASSERT_EQUAL(2, keys.size());
+    TEST_ASSERT_EQUAL_INT16(0, keys[0].x);
+    TEST_ASSERT_EQUAL_INT16(990, keys[1].x);
+    TEST_ASSERT_EQUAL_INT16(1495, keys[1].y);
+}
+
+// 只有一个采样点的轨迹：起点与结束点相同
+static void test_single_sample_track() {
+    TrackCompressor tc;
+    TrajPoint p;
+    TEST_ASSERT_TRUE(tc.add(500, -120, 3400, 100, p));
+    TEST_ASSERT_EQUAL_UINT8(0, p.end);
+    TEST_ASSERT_TRUE(tc.finish(p));
+    TEST_ASSERT_EQUAL_UINT32(500, p.ts);
+    TEST_ASSERT_EQUAL_INT16(-120, p.x);
+    TEST_ASSERT_EQUAL_INT16(3400, p.y);
+    TEST_ASSERT_EQUAL_UINT8(1, p.end);
+    TEST_ASSERT_FALSE(tc.finish(p));
+    TEST_ASSERT_FALSE(tc.isActive());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_error_bound_min_tolerance);
+    RUN_TEST(test_error_bound_default_tolerance);
+    RUN_TEST(test_error_bound_large_tolerance);
+    RUN_TEST(test_error_bound_noisy);
+    RUN_TEST(test_straight_line_keeps_endpoints);
+    RUN_TEST(test_single_sample_track);
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""USB 二进制流(bin 模式)主机端解码器。
+
+从串口或抓取的文件读取以 0x00 分隔的 COBS 帧，校验 CRC16 后输出 CSV，
+并统计序号缺口(设备端丢弃或主机丢字节)。格式定义见 src/stream/binary_stream.h。
+每条记录前后各有一个 0x00，混入的文本(二进制流模式下设备已暂停日志，但切换瞬间或异常输出仍可能出现)
+会成为单独的块，因 CRC 校验失败被跳过并计入 bad，不会连带丢失下一条记录。
+用法：
+    python3 tools/binary_stream_decoder.py --port /dev/ttyUSB0 --baud 256000 > frames.csv
+    python3 tools/binary_stream_decoder.py --file capture.bin > frames.csv
+串口模式下会先发送 "bin" 进入二进制流模式，Ctrl+C 退出时发送 "parse" 恢复。
+"""
+
+import argparse
+import struct
+import sys
+
+RECORD_FRAME = 0x01
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad cobs")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def parse_record(rec):
+    """返回 (seq, ts_ms, sensor, [(x, y, speed, resolution), ...])，无效记录返回 None。"""
+    if len(rec) < 13 or rec[0] != RECORD_FRAME:
+        return None
+    if crc16_ccitt(rec[:-2]) != struct.unpack_from("<H", rec, len(rec) - 2)[0]:
+        return None
+    seq, ts, sensor, n = struct.unpack_from("<IIBB", rec, 1)
+    if len(rec) != 11 + n * 8 + 2:
+        return None
+    targets = [struct.unpack_from("<hhhH", rec, 11 + i * 8) for i in range(n)]
+    return seq, ts, sensor, targets
+
+
+class Decoder:
+    def __init__(self, out):
+        self.out = out
+        self.buf = bytearray()
+        self.frames = self.bad = self.gaps = self.lost = 0
+        self.last_seq = None
+        out.write("seq,ts_ms,sensor,target,x,y,speed,resolution\n")
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            end = self.buf.find(b"\x00")
+            if end < 0:
+                return
+            chunk = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            if not chunk:
+                continue
+            try:
+                rec = parse_record(cobs_decode(chunk))
+            except ValueError:
+                rec = None
+            if rec is None:
+                self.bad += 1
+                continue
+            seq, ts, sensor, targets = rec
+            if self.last_seq is not None and seq != (self.last_seq + 1) & 0xFFFFFFFF:
+                self.gaps += 1
+                self.lost += (seq - self.last_seq - 1) & 0xFFFFFFFF
+            self.last_seq = seq
+            self.frames += 1
+            for i, (x, y, speed, res) in enumerate(targets):
+                self.out.write(f"{seq},{ts},{sensor},{i + 1},{x},{y},{speed},{res}\n")
+
+    def summary(self):
+        return (f"frames={self.frames} bad={self.bad} gaps={self.gaps} lost={self.lost}")
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    src = p.add_mutually_exclusive_group(required=True)
+    src.add_argument("--port")
+    src.add_argument("--file")
+    p.add_argument("--baud", type=int, default=256000)
+    args = p.parse_args()
+
+    dec = Decoder(sys.stdout)
+    if args.file:
+        with open(args.file, "rb") as f:
+            dec.feed(f.read())
+    else:
+        import serial  # pip install pyserial
+        ser = serial.Serial(args.port, args.baud, timeout=0.2)
+        ser.write(b"bin\n")
+        try:
+            while True:
+                dec.feed(ser.read(4096))
+        except KeyboardInterrupt:
+            ser.write(b"\nparse\n")
+        finally:
+            ser.close()
+    print(dec.summary(), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
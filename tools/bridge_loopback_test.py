@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""透传桥接满速吞吐验证。
+
+接线：断开雷达，将 ESP32 的 GPIO17(TX) 与 GPIO16(RX) 短接，使桥接数据回环。
+控制台波特率与雷达串口波特率需一致(默认均为 256000)。
+脚本会：进入 bridge 模式 -> 以线速持续发送随机数据并校验回环 -> 发送退出序列 -> 打印设备统计。
+依赖 pyserial：pip install pyserial
+用法：
+    python3 tools/bridge_loopback_test.py --port /dev/ttyUSB0 --seconds 30
+"""
+
+import argparse
+import os
+import threading
+import time
+
+import serial
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--port", required=True)
+    p.add_argument("--baud", type=int, default=256000)
+    p.add_argument("--seconds", type=float, default=30.0)
+    p.add_argument("--escape", default="+++")
+    p.add_argument("--guard", type=float, default=1.2, help="退出序列前后的静默时间(秒)")
+    args = p.parse_args()
+
+    ser = serial.Serial(args.port, args.baud, timeout=0.1)
+    ser.reset_input_buffer()
+    ser.write(b"bridge\n" if args.escape == "+++" else f"bridge {args.escape}\n".encode())
+    time.sleep(1.0)
+    ser.reset_input_buffer()
+
+    # 线速 = baud / 10 字节每秒 (8N1)
+    line_rate = args.baud // 10
+    total = int(line_rate * args.seconds)
+    payload = os.urandom(total)
+    received = bytearray()
+
+    def reader():
+        deadline = time.monotonic() + args.seconds + 3.0
+        while len(received) < total and time.monotonic() < deadline:
+            received.extend(ser.read(4096))
+
+    t = threading.Thread(target=reader)
+    t.start()
+    start = time.monotonic()
+    chunk = 1024
+    for i in range(0, total, chunk):
+        ser.write(payload[i:i + chunk])
+    ser.flush()
+    t.join()
+    elapsed = time.monotonic() - start
+
+    mismatch = next((i for i, (a, b) in enumerate(zip(payload, received)) if a != b), None)
+    print(f"sent     : {total} B")
+    print(f"received : {len(received)} B ({len(received) / elapsed:.0f} B/s, line rate {line_rate} B/s)")
+    print(f"lost     : {total - len(received)} B")
+    print("integrity: " + ("OK" if mismatch is None and len(received) == total else f"FIRST MISMATCH @ {mismatch}"))
+
+    # 退出桥接并读取设备端统计
+    time.sleep(args.guard)
+    ser.write(args.escape.encode())
+    time.sleep(args.guard)
+    ser.write(b"\n")
+    time.sleep(0.5)
+    print(ser.read(4096).decode(errors="replace"))
+    ser.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+"""flash 抓包(capture 命令)的下载、解析与回放工具。
+
+块/记录格式见 src/capture/raw_capture.h：每块 4096 字节自描述，记录为
+{t_us uint32, src uint8, len uint16, data}，src 低 4 位为传感器编号，0x10 表示指令 ACK 帧。
+用法：
+    python3 tools/capture_tool.py download --port /dev/ttyUSB0 -o cap.ldcap   # 设备上先 capture stop
+    python3 tools/capture_tool.py info cap.ldcap
+    python3 tools/capture_tool.py extract cap.ldcap --sensor 0 -o s0.bin      # 原始字节流(不含 ACK)
+    python3 tools/capture_tool.py frames cap.ldcap > frames.csv               # 解码数据帧
+    python3 tools/capture_tool.py replay cap.ldcap --sensor 0 --port /dev/ttyUSB1 [--speed 2]
+replay 按抓包时的时间间隔把字节写到另一个串口(波特率取自块头)，可接 USB 转串口模拟雷达，
+把现场字节流原样喂给控制器或官方上位机。
+"""
+
+import argparse
+import re
+import struct
+import sys
+import time
+import zlib
+
+BLOCK_SIZE = 4096
+HEADER_SIZE = 32
+RECORD_HEADER = 7
+MAGIC = b"LDCB"
+SRC_ACK = 0x10
+FRAME_HEAD = b"\xAA\xFF\x03\x00"
+FRAME_TAIL = b"\x55\xCC"
+FRAME_LEN = 30
+
+
+def parse_blocks(data):
+    """返回按块序号排序的 [(seq, header dict, [(t_us, src, bytes)])]，t_us 已展开为单调时间。"""
+    blocks = []
+    for off in range(0, len(data) - BLOCK_SIZE + 1, BLOCK_SIZE):
+        b = data[off:off + BLOCK_SIZE]
+        if b[:4] != MAGIC:
+            continue
+        seq, used, version, sensors, dropped = struct.unpack_from("<IHBBI", b, 4)
+        bauds = struct.unpack_from("<3I", b, 16)
+        if used < HEADER_SIZE or used > BLOCK_SIZE:
+            continue
+        records = []
+        pos = HEADER_SIZE
+        while pos + RECORD_HEADER <= used:
+            t, src, n = struct.unpack_from("<IBH", b, pos)
+            pos += RECORD_HEADER
+            records.append((t, src, bytes(b[pos:pos + n])))
+            pos += n
+        hdr = {"version": version, "sensors": sensors, "dropped": dropped, "bauds": bauds[:sensors]}
+        blocks.append((seq, hdr, records))
+    blocks.sort(key=lambda x: x[0])
+
+    # micros() 约 71.6 分钟回绕一次，按记录顺序展开
+    base = 0
+    last = None
+    for _, _, records in blocks:
+        for i, (t, src, payload) in enumerate(records):
+            if last is not None and t < last and last - t > 0x80000000:
+                base += 1 << 32
+            last = t
+            records[i] = (base + t, src, payload)
+    return blocks
+
+
+def records_of(blocks, sensor=None, acks=False):
+    for _, _, records in blocks:
+        for t, src, payload in records:
+            if sensor is not None and (src & 0x0F) != sensor:
+                continue
+            if bool(src & SRC_ACK) != acks:
+                continue
+            yield t, src & 0x0F, payload
+
+
+def decode_coord(raw):
+    # 最高位为 1 表示正值(raw - 2^15)，为 0 表示负值(-raw)
+    return raw - 0x8000 if raw & 0x8000 else -raw
+
+
+def cmd_download(args):
+    import serial  # pip install pyserial
+    ser = serial.Serial(args.port, args.baud, timeout=args.timeout)
+    ser.reset_input_buffer()
+    ser.write(b"\ncapture dump\n")
+    buf = bytearray()
+    deadline = time.monotonic() + args.timeout
+    while True:
+        m = re.search(rb"CAPTURE BEGIN (\d+) (\d+)\r?\n", buf)
+        if m:
+            break
+        if b"stop it first" in buf:
+            sys.exit("capture is running, send 'capture stop' first")
+        if time.monotonic() > deadline:
+            sys.exit("no CAPTURE BEGIN from device")
+        buf += ser.read(ser.in_waiting or 1)
+    total = int(m.group(1))
+    payload = bytearray(buf[m.end():])
+    start = time.monotonic()
+    while len(payload) < total + 64 and not re.search(rb"\nCAPTURE END [0-9A-F]{8}\r?\n", payload[total:]):
+        chunk = ser.read(ser.in_waiting or 1)
+        if not chunk:
+            sys.exit("timeout after %d/%d bytes" % (len(payload), total))
+        payload += chunk
+    ser.close()
+    m = re.search(rb"\nCAPTURE END ([0-9A-F]{8})", payload[total:])
+    if m is None:
+        sys.exit("missing CAPTURE END")
+    data = bytes(payload[:total])
+    crc = zlib.crc32(data)
+    if crc != int(m.group(1), 16):
+        sys.exit("CRC mismatch: device %s, received %08X" % (m.group(1).decode(), crc))
+    with open(args.output, "wb") as f:
+        f.write(data)
+    elapsed = time.monotonic() - start
+    print("%d bytes (%d blocks) in %.1f s, CRC %08X OK -> %s"
+          % (total, total // BLOCK_SIZE, elapsed, crc, args.output), file=sys.stderr)
+
+
+def cmd_info(args):
+    blocks = parse_blocks(open(args.file, "rb").read())
+    if not blocks:
+        sys.exit("no capture blocks")
+    seqs = [b[0] for b in blocks]
+    gaps = sum(1 for a, b in zip(seqs, seqs[1:]) if b != a + 1)
+    recs = [r for _, _, rs in blocks for r in rs]
+    print("blocks     : %d (seq %d..%d, %d gaps)" % (len(blocks), seqs[0], seqs[-1], gaps))
+    print("sensors    : %d, baud %s" % (blocks[-1][1]["sensors"], list(blocks[-1][1]["bauds"])))
+    print("dropped    : %d bytes on device" % blocks[-1][1]["dropped"])
+    if recs:
+        span = (recs[-1][0] - recs[0][0]) / 1e6
+        print("span       : %.1f s" % span)
+    for s in range(blocks[-1][1]["sensors"]):
+        data = sum(len(p) for _, _, p in records_of(blocks, s))
+        acks = sum(1 for _ in records_of(blocks, s, acks=True))
+        print("sensor %d   : %d bytes, %d ACK frames" % (s, data, acks))
+
+
+def cmd_extract(args):
+    blocks = parse_blocks(open(args.file, "rb").read())
+    with open(args.output, "wb") as f:
+        n = 0
+        for _, _, payload in records_of(blocks, args.sensor):
+            f.write(payload)
+            n += len(payload)
+    print("%d bytes -> %s" % (n, args.output), file=sys.stderr)
+
+
+def cmd_frames(args):
+    blocks = parse_blocks(open(args.file, "rb").read())
+    print("t_ms,sensor,target,x,y,speed,resolution")
+    for s in range(max(b[1]["sensors"] for b in blocks) if blocks else 0):
+        stream = bytearray()
+        for t, _, payload in records_of(blocks, s):
+            stream += payload
+            while True:
+                i = stream.find(FRAME_HEAD)
+                if i < 0:
+                    del stream[:-3]
+                    break
+                if len(stream) - i < FRAME_LEN:
+                    del stream[:i]
+                    break
+                frame = stream[i:i + FRAME_LEN]
+                if frame[-2:] != FRAME_TAIL:
+                    del stream[:i + 1]
+                    continue
+                del stream[:i + FRAME_LEN]
+                for k in range(3):
+                    x, y, v, res = struct.unpack_from("<HHHH", frame, 4 + k * 8)
+                    if x == 0 and y == 0:
+                        continue
+                    print("%.3f,%d,%d,%d,%d,%d,%d" % (t / 1000.0, s, k + 1, decode_coord(x), decode_coord(y),
+                                                     decode_coord(v), res))
+
+
+def cmd_replay(args):
+    import serial  # pip install pyserial
+    blocks = parse_blocks(open(args.file, "rb").read())
+    bauds = blocks[-1][1]["bauds"] if blocks else ()
+    baud = args.baud or (bauds[args.sensor] if args.sensor < len(bauds) else 256000)
+    ser = serial.Serial(args.port, baud)
+    start = time.monotonic()
+    t0 = None
+    sent = 0
+    for t, _, payload in records_of(blocks, args.sensor):
+        if t0 is None:
+            t0 = t
+        due = start + (t - t0) / 1e6 / args.speed
+        delay = due - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        ser.write(payload)
+        sent += len(payload)
+    ser.flush()
+    ser.close()
+    print("replayed %d bytes at %d baud in %.1f s" % (sent, baud, time.monotonic() - start), file=sys.stderr)
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = p.add_subparsers(dest="cmd", required=True)
+
+    d = sub.add_parser("download", help="通过控制台串口下载抓包")
+    d.add_argument("--port", required=True)
+    d.add_argument("--baud", type=int, default=256000)
+    d.add_argument("--timeout", type=float, default=10.0)
+    d.add_argument("-o", "--output", required=True)
+    d.set_defaults(func=cmd_download)
+
+    i = sub.add_parser("info", help="抓包概要")
+    i.add_argument("file")
+    i.set_defaults(func=cmd_info)
+
+    e = sub.add_parser("extract", help="导出某个传感器的原始字节流")
+    e.add_argument("file")
+    e.add_argument("--sensor", type=int, default=0)
+    e.add_argument("-o", "--output", required=True)
+    e.set_defaults(func=cmd_extract)
+
+    f = sub.add_parser("frames", help="解码数据帧为 CSV")
+    f.add_argument("file")
+    f.set_defaults(func=cmd_frames)
+
+    r = sub.add_parser("replay", help="按原始时间间隔把字节流写到串口")
+    r.add_argument("file")
+    r.add_argument("--sensor", type=int, default=0)
+    r.add_argument("--port", required=True)
+    r.add_argument("--baud", type=int, default=0, help="缺省取块头中记录的波特率")
+    r.add_argument("--speed", type=float, default=1.0, help="回放倍速")
+    r.set_defaults(func=cmd_replay)
+
+    args = p.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+"""本地同步服务器替身，用于验证上传截止时间、熔断器与远程指令通道。
+
+模拟 /api/v1/device/sync 接口，可按概率注入延迟、连接重置、5xx 与黑洞(不响应)。
+同时模拟 /api/v1/device/commands 长轮询接口；向 /admin/enqueue POST 指令即可入队：
+    curl -X POST -d '[{"command_type":"SET_MODE","payload":{"mode":"multi"}}]' http://localhost:5000/admin/enqueue
+    curl -X POST -d '[{"command_type":"SET_ZONE","payload":{"zone_type":1,"zones":[[-1500,0,1500,4000]]}}]' \
+        http://localhost:5000/admin/enqueue
+设备回报的 ACK 会打印“入队 -> 雷达ACK”延迟。
+/api/v1/device/heatmap 接收占用热力图快照分片，按设备与快照序号累加，收到最后一片时打印摘要。
+用法示例：
+    python3 tools/fake_sync_server.py --port 5000 --delay-rate 0.3 --delay-ms 5000 \
+        --reset-rate 0.1 --error-rate 0.2 --blackhole-rate 0.1
+然后把 wifi_config.cpp 中的 SERVER_URL 指向 http://<本机IP>:5000/api/v1/device/sync，
+在串口输入 stats 观察：注入延迟/黑洞期间各传感器帧率与 [LOOP] 行保持平稳(上传在独立任务中执行，
+不阻塞雷达主循环)；超过 SYNC_TOTAL_DEADLINE_MS 仍未读完响应的上传计为失败，熔断器按退避恢复。
+“最长耗时”是上传任务中单次请求的耗时：--delay-ms 超过截止时间的慢响应与黑洞在
+SYNC_TOTAL_DEADLINE_MS 附近被断开，最长耗时应停在截止时间加几十毫秒以内。
+"""
+
+import argparse
+import json
+import random
+import socket
+import struct
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class HeatmapSnapshots:
+    """按 (设备, 快照序号) 累加分片；中止的快照(没有最后一片)只留在内存里。"""
+    lock = threading.Lock()
+    pending = {}
+
+
+class CommandQueue:
+    """长轮询指令队列：入队时唤醒挂起的请求，一次返回全部排队指令。"""
+    cond = threading.Condition()
+    items = []
+    next_id = 1
+
+    @classmethod
+    def enqueue(cls, cmds):
+        if isinstance(cmds, dict):
+            cmds = [cmds]
+        with cls.cond:
+            for c in cmds:
+                c = dict(c, id=cls.next_id)
+                cls.next_id += 1
+                cls.items.append((time.monotonic(), c))
+            cls.cond.notify_all()
+        return len(cmds)
+
+    @classmethod
+    def wait_and_take(cls, timeout):
+        with cls.cond:
+            cls.cond.wait_for(lambda: cls.items, timeout=timeout)
+            now = time.monotonic()
+            out = [dict(c, enqueue_age_ms=int((now - t) * 1000)) for t, c in cls.items]
+            cls.items = []
+        return out
+
+
+class SyncHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.0"
+    args = None
+    counters = {"ok": 0, "delay": 0, "reset": 0, "error": 0, "blackhole": 0}
+
+    def log_message(self, fmt, *a):
+        pass
+
+    def _reset(self):
+        # SO_LINGER=0 后关闭，发送 RST
+        self.connection.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack("ii", 1, 0))
+        self.connection.close()
+
+    def _json(self, code, obj):
+        resp = json.dumps(obj).encode()
+        self.send_response(code)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(resp)))
+        self.end_headers()
+        self.wfile.write(resp)
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        body = self.rfile.read(length) if length else b""
+        if self.path.startswith("/admin/enqueue"):
+            self._json(200, {"queued": CommandQueue.enqueue(json.loads(body or b"[]"))})
+            return
+        if self.path.startswith("/api/v1/device/commands"):
+            self._commands(json.loads(body or b"{}"))
+            return
+        if self.path.startswith("/api/v1/device/heatmap"):
+            self._heatmap(body)
+            return
+        self._sync(body)
+
+    def _commands(self, req):
+        for ack in req.get("acks", []):
+            print(f"\n[ACK] #{ack.get('id')} ok={ack.get('ok')} "
+                  f"latency={ack.get('latency_ms')}ms exec={ack.get('exec_ms')}ms")
+        cmds = CommandQueue.wait_and_take(min(float(req.get("wait", 25)), 60.0))
+        self._json(200, {"data": {"commands": cmds}})
+
+    def _heatmap(self, body):
+        snap = json.loads(body or b"{}")
+        runs = snap.get("runs", [])
+        key = (snap.get("device_mac"), snap.get("seq"))
+        with HeatmapSnapshots.lock:
+            acc = HeatmapSnapshots.pending.setdefault(key, {"chunks": 0, "bytes": 0, "runs": 0, "cells": 0, "dwell": 0})
+            acc["chunks"] += 1
+            acc["bytes"] += len(body)
+            acc["runs"] += len(runs)
+            acc["cells"] += sum(len(r.get("n", [])) for r in runs)
+            acc["dwell"] += sum(sum(r.get("d", [])) for r in runs)
+            if snap.get("last"):
+                del HeatmapSnapshots.pending[key]
+                print(f"\n[HEATMAP] #{snap.get('seq')} {acc['chunks']} chunks {acc['bytes']} B  "
+                      f"period={snap.get('period_ms')}ms frames={snap.get('frames')} "
+                      f"grid={snap.get('cols')}x{snap.get('rows')}@{snap.get('cell_mm')}mm "
+                      f"cells={acc['cells']} runs={acc['runs']} dwell={acc['dwell']}ms")
+        self._json(200, {"data": {"ok": True}})
+
+    def _sync(self, body):
+        a = self.args
+        r = random.random()
+
+        if r < a.reset_rate:
+            self.counters["reset"] += 1
+            self._reset()
+            return
+        r -= a.reset_rate
+
+        if r < a.blackhole_rate:
+            self.counters["blackhole"] += 1
+            time.sleep(a.blackhole_s)
+            self._reset()
+            return
+        r -= a.blackhole_rate
+
+        if r < a.error_rate:
+            self.counters["error"] += 1
+            self.send_response(random.choice([500, 502, 503]))
+            self.end_headers()
+            return
+        r -= a.error_rate
+
+        if r < a.delay_rate:
+            self.counters["delay"] += 1
+            time.sleep(a.delay_ms / 1000.0)
+        else:
+            self.counters["ok"] += 1
+
+        try:
+            req = json.loads(body)
+        except ValueError:
+            req = {}
+        targets = req.get("targets", [])
+        points = req.get("track_points", [])
+        if points:
+            ends = sum(1 for p in points if p[4])
+            print(f"\n[TRAJ] {len(points)} key points, {ends} track ends")
+        self._json(200, {"data": {"next_interval": a.interval, "received": len(targets)}})
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--host", default="0.0.0.0")
+    p.add_argument("--port", type=int, default=5000)
+    p.add_argument("--interval", type=int, default=1000, help="返回的 next_interval (ms)")
+    p.add_argument("--delay-rate", type=float, default=0.0, help="延迟响应的概率")
+    p.add_argument("--delay-ms", type=int, default=3000, help="延迟时长")
+    p.add_argument("--reset-rate", type=float, default=0.0, help="直接 RST 的概率")
+    p.add_argument("--error-rate", type=float, default=0.0, help="返回 5xx 的概率")
+    p.add_argument("--blackhole-rate", type=float, default=0.0, help="读完请求后不响应的概率")
+    p.add_argument("--blackhole-s", type=float, default=30.0, help="黑洞保持时长(秒)")
+    SyncHandler.args = p.parse_args()
+
+    server = ThreadingHTTPServer((SyncHandler.args.host, SyncHandler.args.port), SyncHandler)
+    print(f"fake sync server on {SyncHandler.args.host}:{SyncHandler.args.port}")
+    try:
+        while True:
+            server.handle_request()
+            print("\r" + " ".join(f"{k}={v}" for k, v in SyncHandler.counters.items()), end="", flush=True)
+    except KeyboardInterrupt:
+        print()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""占用热力图校验：用参考实现重算二进制流抓包，并与设备快照逐格对比。
+
+仅适用于单传感器且安装变换为恒等(二进制流记录的是传感器坐标)。
+串口模式：依次发送 heatmap reset / bin，抓取 --seconds 秒后发送 parse / heatmap dump，
+用抓到的帧重算网格并与设备快照比较。
+离线模式：--file 为原始抓包(含二进制帧)，--snapshot 为 heatmap dump 的输出(每行一个分片)。
+依赖 pyserial(仅串口模式)：pip install pyserial
+用法：
+    python3 tools/heatmap_check.py --port /dev/ttyUSB0 --seconds 120
+    python3 tools/heatmap_check.py --file capture.bin --snapshot snap.json
+"""
+
+import argparse
+import json
+import re
+import sys
+import time
+
+from binary_stream_decoder import cobs_decode, parse_record
+
+MAX_FRAME_DT_MS = 500   # 与 HEATMAP_MAX_FRAME_DT_MS 一致
+
+
+def decode_frames(raw):
+    """从原始字节中取出全部有效记录：[(seq, ts, targets), ...]"""
+    frames = []
+    for chunk in raw.split(b"\x00"):
+        if not chunk:
+            continue
+        try:
+            rec = cobs_decode(chunk)
+        except ValueError:
+            continue
+        rec = parse_record(rec)
+        if rec is not None:
+            seq, ts, _sensor, targets = rec
+            frames.append((seq, ts, targets))
+    return frames
+
+
+def reference_grid(frames, snap):
+    """参考实现：与设备端 heatmapAddFrame 相同的规则。"""
+    cell, ox, oy = snap["cell_mm"], snap["origin_x"], snap["origin_y"]
+    cols, rows = snap["cols"], snap["rows"]
+    grid = {}
+    last_ts = None
+    for _seq, ts, targets in frames:
+        dt = 0 if last_ts is None else min((ts - last_ts) & 0xFFFFFFFF, MAX_FRAME_DT_MS)
+        last_ts = ts
+        for x, y, _speed, res in targets:
+            if (x == 0 and y == 0) or res == 0:
+                continue
+            if x < ox or y < oy:
+                continue
+            cx, cy = (x - ox) // cell, (y - oy) // cell
+            if cx >= cols or cy >= rows:
+                continue
+            d, n = grid.get(cy * cols + cx, (0, 0))
+            grid[cy * cols + cx] = (d + dt, n + 1)
+    return grid
+
+
+def merge_chunks(chunks):
+    """把 heatmap dump 的各分片合并为一个快照(格值按下标累加)。"""
+    snap = dict(chunks[0])
+    snap["runs"] = [run for c in chunks for run in c["runs"]]
+    return snap
+
+
+def snapshot_grid(snap):
+    grid = {}
+    for run in snap["runs"]:
+        for k, (d, n) in enumerate(zip(run["d"], run["n"])):
+            a = grid.get(run["i"] + k, (0, 0))
+            grid[run["i"] + k] = (a[0] + d, a[1] + n)
+    return grid
+
+
+def compare(frames, snap):
+    ref, dev = reference_grid(frames, snap), snapshot_grid(snap)
+    seqs = [f[0] for f in frames]
+    lost = sum(((b - a - 1) & 0xFFFFFFFF) for a, b in zip(seqs, seqs[1:]))
+    print(f"frames: captured={len(frames)} lost={lost} device={snap['frames']}")
+    print(f"cells : reference={len(ref)} device={len(dev)}  snapshot runs={len(snap['runs'])} "
+          f"chunks={snap.get('chunks', 1)}")
+    count_err = sum(abs(ref.get(i, (0, 0))[1] - dev.get(i, (0, 0))[1]) for i in set(ref) | set(dev))
+    dwell_err = sum(abs(ref.get(i, (0, 0))[0] - dev.get(i, (0, 0))[0]) for i in set(ref) | set(dev))
+    total = sum(d for d, _ in ref.values()) or 1
+    print(f"diff  : count={count_err} dwell={dwell_err}ms ({100.0 * dwell_err / total:.2f}% of {total}ms)")
+    # 允许首尾各差一帧(抓包开始/结束与设备处理命令之间的帧)
+    ok = lost == 0 and abs(snap["frames"] - len(frames)) <= 2 and count_err <= 6
+    print("result: " + ("MATCH" if ok else "MISMATCH"))
+    return ok
+
+
+def capture(port, baud, seconds):
+    import serial  # pip install pyserial
+    ser = serial.Serial(port, baud, timeout=0.2)
+    ser.write(b"\nheatmap reset\n")
+    time.sleep(0.5)
+    ser.reset_input_buffer()
+    ser.write(b"bin\n")
+    raw = bytearray()
+    end = time.monotonic() + seconds
+    while time.monotonic() < end:
+        raw += ser.read(4096)
+    ser.write(b"\nparse\nheatmap dump\n")
+    end = time.monotonic() + 5
+    while time.monotonic() < end and not re.search(rb'\{"device_mac".*"last":true.*\}\r?\n', raw):
+        raw += ser.read(4096)
+    ser.close()
+    chunks = list(re.finditer(rb'\{"device_mac".*\}', raw))
+    if not chunks or b'"last":true' not in chunks[-1].group(0):
+        sys.exit("no complete heatmap snapshot received")
+    return bytes(raw[:chunks[0].start()]), load_chunks(m.group(0) for m in chunks)
+
+
+def load_chunks(lines):
+    chunks = [json.loads(line) for line in lines if line.strip()]
+    snap = merge_chunks(chunks)
+    snap["chunks"] = len(chunks)
+    return snap
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--port")
+    p.add_argument("--baud", type=int, default=256000)
+    p.add_argument("--seconds", type=float, default=60.0)
+    p.add_argument("--file")
+    p.add_argument("--snapshot")
+    args = p.parse_args()
+
+    if args.port:
+        raw, snap = capture(args.port, args.baud, args.seconds)
+    elif args.file and args.snapshot:
+        with open(args.file, "rb") as f:
+            raw = f.read()
+        with open(args.snapshot) as f:
+            snap = load_chunks(f)
+    else:
+        p.error("need --port, or --file with --snapshot")
+    sys.exit(0 if compare(decode_frames(raw), snap) else 1)
+
+
+if __name__ == "__main__":
+    main()